@@ -0,0 +1,488 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))) || defined(_M_X64)
+    #include <immintrin.h>
+    #define BATCH_X86
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define BATCH_AVX2_TARGET
+        #define BATCH_AVX2_ENTRY
+    #else
+        #define BATCH_AVX2_TARGET __attribute__((target("avx2")))
+        #define BATCH_AVX2_ENTRY __attribute__((target("avx2"), flatten))
+    #endif
+#endif
+
+#include "../Models/Record.h"
+#include "Geometry.h"
+#include "Score.h"
+
+using namespace std;
+
+// Пакетная генерация ходов и оценка материала для многих независимых позиций 8 x 8 (self-play, разметка данных,
+// подсчёт ходов). Позиции хранятся структурой массивов масок тёмных клеток (как в Models/Record.h), и одна
+// последовательность битовых операций обрабатывает сразу 8 (AVX2), 4 (SSE2) или 1 позицию - без ветвлений
+// по клеткам и фигурам, как в Logic::find_turns. Для каждой позиции считается количество шагов-ходов ходящего
+// (turns.size() после Logic::find_turns, с обязательным взятием и дальнобойными дамками), есть ли взятие
+// и оценка материала Logic::calc_score с точки зрения ходящего. Набор команд выбирается при запуске
+// по процессору (best_kernel), скалярный вариант работает везде.
+struct batch_positions
+{
+    vector<uint32_t> white, black, kings; // маски фигур
+    vector<uint32_t> side;                // кто ходит: 0 - белые, 1 - черные
+
+    size_t size() const
+    {
+        return white.size();
+    }
+
+    void clear()
+    {
+        white.clear();
+        black.clear();
+        kings.clear();
+        side.clear();
+    }
+
+    void push(const position_record &rec)
+    {
+        white.push_back(rec.white);
+        black.push_back(rec.black);
+        kings.push_back(rec.kings);
+        side.push_back(rec.side);
+    }
+
+    void push(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        position_record rec{};
+        pack_board(mtx, rec);
+        rec.side = color;
+        push(rec);
+    }
+};
+
+struct batch_results
+{
+    vector<uint32_t> turns; // количество шагов-ходов ходящего
+    vector<uint32_t> beats; // 1 - ходящий обязан брать
+    vector<SCORE_T> score;  // оценка с точки зрения ходящего
+};
+
+// Соседняя клетка по направлению d (как в Engine/Geometry.h) - сдвиг маски, зависящий от чётности ряда:
+// src[d][p] - клетки рядов чётности p, у которых есть сосед, shift[d][p] - разность номеров клеток
+struct batch_steps
+{
+    uint32_t src[4][2];
+    int shift[4][2];
+};
+
+constexpr batch_steps make_batch_steps()
+{
+    batch_steps s{};
+    const auto &t = GEOMETRY_TABLES<8>;
+    for (int c = 0; c < Geometry_8::CELLS; ++c)
+    {
+        const int p = c / 4 % 2;
+        for (int d = 0; d < 4; ++d)
+        {
+            if (!t.ray_len[c][d])
+                continue;
+            s.src[d][p] |= uint32_t(1) << c;
+            s.shift[d][p] = Geometry_8::cell(t.ray[c][d][0].x, t.ray[c][d][0].y) - c;
+        }
+    }
+    return s;
+}
+
+inline constexpr batch_steps BATCH_STEPS = make_batch_steps();
+
+// Маски клеток, у которых номер ряда (idx / 4) содержит бит 0, 1 и 2
+const uint32_t BATCH_ROW_BIT0 = 0xf0f0f0f0, BATCH_ROW_BIT1 = 0xff00ff00, BATCH_ROW_BIT2 = 0xffff0000;
+
+// Полоса из одной позиции
+struct lane_1
+{
+    static const int WIDTH = 1;
+    uint32_t v;
+
+    static lane_1 set(const uint32_t x)
+    {
+        return {x};
+    }
+    static lane_1 load(const uint32_t *p)
+    {
+        return {*p};
+    }
+    void store(uint32_t *p) const
+    {
+        *p = v;
+    }
+};
+
+inline lane_1 operator&(const lane_1 &a, const lane_1 &b)
+{
+    return {a.v & b.v};
+}
+inline lane_1 operator|(const lane_1 &a, const lane_1 &b)
+{
+    return {a.v | b.v};
+}
+inline lane_1 operator+(const lane_1 &a, const lane_1 &b)
+{
+    return {a.v + b.v};
+}
+inline lane_1 operator-(const lane_1 &a, const lane_1 &b)
+{
+    return {a.v - b.v};
+}
+inline lane_1 andnot(const lane_1 &a, const lane_1 &b)
+{
+    return {~a.v & b.v};
+}
+template <int N> inline lane_1 shl(const lane_1 &a)
+{
+    return {a.v << N};
+}
+template <int N> inline lane_1 shr(const lane_1 &a)
+{
+    return {a.v >> N};
+}
+inline lane_1 popcount(const lane_1 &a)
+{
+    uint32_t x = a.v;
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0f0f0f0f;
+    return {(x * 0x01010101) >> 24};
+}
+inline lane_1 zero_mask(const lane_1 &a)
+{
+    return {a.v ? 0u : ~0u};
+}
+
+#ifdef BATCH_X86
+// Полоса из 4 позиций (SSE2)
+struct lane_4
+{
+    static const int WIDTH = 4;
+    __m128i v;
+
+    static lane_4 set(const uint32_t x)
+    {
+        return {_mm_set1_epi32(int(x))};
+    }
+    static lane_4 load(const uint32_t *p)
+    {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))};
+    }
+    void store(uint32_t *p) const
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+    }
+};
+
+inline lane_4 operator&(const lane_4 &a, const lane_4 &b)
+{
+    return {_mm_and_si128(a.v, b.v)};
+}
+inline lane_4 operator|(const lane_4 &a, const lane_4 &b)
+{
+    return {_mm_or_si128(a.v, b.v)};
+}
+inline lane_4 operator+(const lane_4 &a, const lane_4 &b)
+{
+    return {_mm_add_epi32(a.v, b.v)};
+}
+inline lane_4 operator-(const lane_4 &a, const lane_4 &b)
+{
+    return {_mm_sub_epi32(a.v, b.v)};
+}
+inline lane_4 andnot(const lane_4 &a, const lane_4 &b)
+{
+    return {_mm_andnot_si128(a.v, b.v)};
+}
+template <int N> inline lane_4 shl(const lane_4 &a)
+{
+    return {_mm_slli_epi32(a.v, N)};
+}
+template <int N> inline lane_4 shr(const lane_4 &a)
+{
+    return {_mm_srli_epi32(a.v, N)};
+}
+inline lane_4 popcount(const lane_4 &a)
+{
+    const __m128i m1 = _mm_set1_epi32(0x55555555), m2 = _mm_set1_epi32(0x33333333), m4 = _mm_set1_epi32(0x0f0f0f0f);
+    __m128i x = _mm_sub_epi32(a.v, _mm_and_si128(_mm_srli_epi32(a.v, 1), m1));
+    x = _mm_add_epi32(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi32(x, 2), m2));
+    x = _mm_and_si128(_mm_add_epi32(x, _mm_srli_epi32(x, 4)), m4);
+    x = _mm_add_epi32(x, _mm_srli_epi32(x, 8));
+    x = _mm_add_epi32(x, _mm_srli_epi32(x, 16));
+    return {_mm_and_si128(x, _mm_set1_epi32(0x3f))};
+}
+inline lane_4 zero_mask(const lane_4 &a)
+{
+    return {_mm_cmpeq_epi32(a.v, _mm_setzero_si128())};
+}
+
+// Полоса из 8 позиций (AVX2), используется только после проверки процессора
+struct lane_8
+{
+    static const int WIDTH = 8;
+    __m256i v;
+
+    BATCH_AVX2_TARGET static lane_8 set(const uint32_t x)
+    {
+        return {_mm256_set1_epi32(int(x))};
+    }
+    BATCH_AVX2_TARGET static lane_8 load(const uint32_t *p)
+    {
+        return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))};
+    }
+    BATCH_AVX2_TARGET void store(uint32_t *p) const
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+};
+
+BATCH_AVX2_TARGET inline lane_8 operator&(const lane_8 &a, const lane_8 &b)
+{
+    return {_mm256_and_si256(a.v, b.v)};
+}
+BATCH_AVX2_TARGET inline lane_8 operator|(const lane_8 &a, const lane_8 &b)
+{
+    return {_mm256_or_si256(a.v, b.v)};
+}
+BATCH_AVX2_TARGET inline lane_8 operator+(const lane_8 &a, const lane_8 &b)
+{
+    return {_mm256_add_epi32(a.v, b.v)};
+}
+BATCH_AVX2_TARGET inline lane_8 operator-(const lane_8 &a, const lane_8 &b)
+{
+    return {_mm256_sub_epi32(a.v, b.v)};
+}
+BATCH_AVX2_TARGET inline lane_8 andnot(const lane_8 &a, const lane_8 &b)
+{
+    return {_mm256_andnot_si256(a.v, b.v)};
+}
+template <int N> BATCH_AVX2_TARGET inline lane_8 shl(const lane_8 &a)
+{
+    return {_mm256_slli_epi32(a.v, N)};
+}
+template <int N> BATCH_AVX2_TARGET inline lane_8 shr(const lane_8 &a)
+{
+    return {_mm256_srli_epi32(a.v, N)};
+}
+// Подсчёт битов по полубайтам таблицей (vpshufb), затем сумма байтов каждого 32-битного слова
+BATCH_AVX2_TARGET inline lane_8 popcount(const lane_8 &a)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2,
+                                           2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(a.v, low)),
+                                          _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(a.v, 4), low)));
+    const __m256i pairs = _mm256_maddubs_epi16(bytes, _mm256_set1_epi8(1));
+    return {_mm256_madd_epi16(pairs, _mm256_set1_epi16(1))};
+}
+BATCH_AVX2_TARGET inline lane_8 zero_mask(const lane_8 &a)
+{
+    return {_mm256_cmpeq_epi32(a.v, _mm256_setzero_si256())};
+}
+#endif
+
+class Batch
+{
+  public:
+    enum kernel
+    {
+        SCALAR = 0,
+        SSE2 = 1,
+        AVX2 = 2
+    };
+
+    // Лучший набор команд, доступный на этом процессоре
+    static kernel best_kernel()
+    {
+#ifdef BATCH_X86
+        return has_avx2() ? AVX2 : SSE2;
+#else
+        return SCALAR;
+#endif
+    }
+
+    static bool supported(const kernel k)
+    {
+        return k <= best_kernel();
+    }
+
+    static const char *name(const kernel k)
+    {
+        return k == AVX2 ? "avx2" : (k == SSE2 ? "sse2" : "scalar");
+    }
+
+    // Ходы и оценка всех позиций пакета. potential_coef и q_coef - коэффициенты Logic::calc_score.
+    // Недоступный процессору набор команд заменяется лучшим доступным
+    static void run(const batch_positions &pos, batch_results &res, const double potential_coef, const double q_coef,
+                    kernel k = best_kernel())
+    {
+        const size_t n = pos.size();
+        res.turns.resize(n);
+        res.beats.resize(n);
+        res.score.resize(n);
+        if (!supported(k))
+            k = best_kernel();
+        size_t done = 0;
+#ifdef BATCH_X86
+        if (k == AVX2)
+            done = run_avx2(pos, res, potential_coef, q_coef);
+        else if (k == SSE2)
+            done = run_lanes<lane_4>(pos, res, potential_coef, q_coef, 0, n);
+#endif
+        // Остаток пакета, не кратный ширине полосы
+        run_lanes<lane_1>(pos, res, potential_coef, q_coef, done, n);
+    }
+
+  private:
+#ifdef BATCH_X86
+    static bool has_avx2()
+    {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+
+    BATCH_AVX2_ENTRY static size_t run_avx2(const batch_positions &pos, batch_results &res, const double potential_coef,
+                                            const double q_coef)
+    {
+        return run_lanes<lane_8>(pos, res, potential_coef, q_coef, 0, pos.size());
+    }
+#endif
+
+    template <int N, class L> static L shift(const L &x)
+    {
+        if constexpr (N > 0)
+            return shl<N>(x);
+        else
+            return shr<-N>(x);
+    }
+
+    // Соседи всех клеток маски по направлению D
+    template <int D, class L> static L step(const L &x)
+    {
+        return shift<BATCH_STEPS.shift[D][0]>(x & L::set(BATCH_STEPS.src[D][0])) |
+               shift<BATCH_STEPS.shift[D][1]>(x & L::set(BATCH_STEPS.src[D][1]));
+    }
+
+    // Сумма номеров рядов по маске
+    template <class L> static L row_sum(const L &x)
+    {
+        return popcount(x & L::set(BATCH_ROW_BIT0)) + shl<1>(popcount(x & L::set(BATCH_ROW_BIT1))) +
+               shl<2>(popcount(x & L::set(BATCH_ROW_BIT2)));
+    }
+
+    template <class L> static L select(const L &mask, const L &a, const L &b)
+    {
+        return (mask & a) | andnot(mask, b);
+    }
+
+    // Взятия шашками по направлению D: соседняя фигура противника и свободная клетка за ней.
+    // Клетки назначения разных шашек не совпадают, поэтому количество взятий - число битов
+    template <int D, class L> static L men_captures(const L &men, const L &opp, const L &empty)
+    {
+        return popcount(step<D>(step<D>(men) & opp) & empty);
+    }
+
+    // Дамки по направлению D: луч идёт по свободным клеткам (тихие ходы), первая фигура противника на луче
+    // берётся с приземлением на любую свободную клетку за ней. Лучи разных дамок одного направления
+    // не пересекаются (своя фигура закрывает луч), поэтому клетки можно собирать в одну маску
+    template <int D, class L> static void king_rays(const L &kings, const L &opp, const L &empty, L &captures, L &quiet)
+    {
+        L ray = step<D>(kings), free = L::set(0), hit = L::set(0);
+        for (int k = 0; k < 7; ++k)
+        {
+            const L next = ray & empty;
+            free = free | next;
+            hit = hit | (ray & opp);
+            ray = step<D>(next);
+        }
+        L land = step<D>(hit) & empty, landed = L::set(0);
+        for (int k = 0; k < 6; ++k)
+        {
+            landed = landed | land;
+            land = step<D>(land) & empty;
+        }
+        quiet = quiet + popcount(free);
+        captures = captures + popcount(landed);
+    }
+
+    // Оценка материала как у Logic::calc_score: (шашки + потенциал + дамки * q) своих / чужих
+    static SCORE_T material_score(const uint32_t men, const uint32_t kings, const uint32_t pot, const uint32_t opp_men,
+                                  const uint32_t opp_kings, const uint32_t opp_pot, const double potential_coef,
+                                  const double q_coef)
+    {
+        if (opp_men + opp_kings == 0)
+            return WIN_SCORE;
+        if (men + kings == 0)
+            return -WIN_SCORE;
+        return ratio_score((men + potential_coef * pot + kings * q_coef) /
+                           (opp_men + potential_coef * opp_pot + opp_kings * q_coef));
+    }
+
+    // Позиции from..to полосами L, возвращает номер первой необработанной позиции
+    template <class L>
+    static size_t run_lanes(const batch_positions &pos, batch_results &res, const double potential_coef,
+                            const double q_coef, const size_t from, const size_t to)
+    {
+        size_t i = from;
+        for (; i + L::WIDTH <= to; i += L::WIDTH)
+        {
+            const L white = L::load(&pos.white[i]), black = L::load(&pos.black[i]), kings = L::load(&pos.kings[i]);
+            const L black_side = L::set(0) - L::load(&pos.side[i]); // все биты, если ходят черные
+            const L own = select(black_side, black, white), opp = select(black_side, white, black);
+            const L empty = andnot(white | black, L::set(~0u));
+            const L men = andnot(kings, own), own_kings = own & kings;
+
+            // Взятия во все стороны, тихие ходы шашек - вперёд (белые по 0 и 1, черные по 2 и 3)
+            L captures = men_captures<0>(men, opp, empty) + men_captures<1>(men, opp, empty) +
+                         men_captures<2>(men, opp, empty) + men_captures<3>(men, opp, empty);
+            L quiet = popcount(select(black_side, step<2>(men), step<0>(men)) & empty) +
+                      popcount(select(black_side, step<3>(men), step<1>(men)) & empty);
+            king_rays<0>(own_kings, opp, empty, captures, quiet);
+            king_rays<1>(own_kings, opp, empty, captures, quiet);
+            king_rays<2>(own_kings, opp, empty, captures, quiet);
+            king_rays<3>(own_kings, opp, empty, captures, quiet);
+            const L no_beats = zero_mask(captures);
+            select(no_beats, quiet, captures).store(&res.turns[i]);
+            andnot(no_beats, L::set(1)).store(&res.beats[i]);
+
+            // Потенциал белых шашек - 7 - ряд, черных - ряд
+            const L white_men = andnot(kings, white), black_men = andnot(kings, black);
+            const L white_count = popcount(white_men);
+            const L white_pot = shl<3>(white_count) - white_count - row_sum(white_men);
+            const L black_pot = row_sum(black_men);
+            uint32_t c[6][L::WIDTH];
+            popcount(men).store(c[0]);
+            popcount(own_kings).store(c[1]);
+            select(black_side, black_pot, white_pot).store(c[2]);
+            popcount(andnot(kings, opp)).store(c[3]);
+            popcount(opp & kings).store(c[4]);
+            select(black_side, white_pot, black_pot).store(c[5]);
+            for (int k = 0; k < L::WIDTH; ++k)
+                res.score[i + k] = material_score(c[0][k], c[1][k], c[2][k], c[3][k], c[4][k], c[5][k], potential_coef,
+                                                  q_coef);
+        }
+        return i;
+    }
+};
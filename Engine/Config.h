@@ -0,0 +1,43 @@
+#pragma once
+#include <fstream>
+#include <string>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+using namespace std;
+
+#include "../Models/Project_path.h"
+
+class Config
+{
+  public:
+    Config(const string &path = project_path + "settings.json") : path(path)
+    {
+        reload();
+    }
+
+    // Загружает настройки из файла settings.json (или переданного в конструктор) и сохраняет в объект config.
+    // Возвращает true, если настройки изменились.
+    bool reload()
+    {
+        json old = move(config);
+        std::ifstream fin(path);
+        fin >> config;
+        fin.close();
+        return config != old;
+    }
+    // Позволяет удобно получать значения из config по указанным ключам. Пример config("Game", "MaxNumTurns").
+    auto operator()(const string &setting_dir, const string &setting_name) const
+    {
+        return config[setting_dir][setting_name];
+    }
+
+    // Переопределяет значение настройки в памяти (файл не изменяется), например NoRandom для бенчмарка.
+    void set(const string &setting_dir, const string &setting_name, const json &value)
+    {
+        config[setting_dir][setting_name] = value;
+    }
+
+  private:
+    string path;
+    json config;
+};
@@ -0,0 +1,179 @@
+#define CHECKERS_ENGINE_BUILD
+#include "Engine_api.h"
+
+#include <chrono>
+
+#include "Config.h"
+#include "Logic.h"
+
+struct ck_engine
+{
+    ck_engine(const string &path) : config(path), logic(&config), mtx(Logic::start_mtx())
+    {
+    }
+
+    Config config;
+    Logic logic;
+    vector<vector<POS_T>> mtx;
+    bool color = 0;
+    vector<move_pos> best;
+    vector<pv_line> lines; // результат ck_engine_analyse
+    ck_stats stats{};
+};
+
+static search_limits to_limits(const ck_limits *limits)
+{
+    search_limits res;
+    res.level = limits->level;
+    res.nodes = limits->nodes;
+    res.time_ms = limits->time_ms;
+    return res;
+}
+
+static ck_move to_ck_move(const move_pos &turn)
+{
+    return ck_move{turn.x, turn.y, turn.x2, turn.y2, turn.xb, turn.yb};
+}
+
+int ck_api_version(void)
+{
+    return CK_API_VERSION;
+}
+
+ck_engine *ck_engine_create(const char *settings_path)
+{
+    try
+    {
+        return new ck_engine(settings_path ? string(settings_path) : project_path + "settings.json");
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void ck_engine_destroy(ck_engine *engine)
+{
+    delete engine;
+}
+
+int ck_engine_set_option(ck_engine *engine, const char *section, const char *name, const char *value)
+{
+    if (!engine || !section || !name || !value)
+        return -1;
+    try
+    {
+        engine->config.set(section, name, json::parse(value));
+        engine->logic = Logic(&engine->config); // настройки бота читаются в конструкторе
+    }
+    catch (...)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int ck_engine_set_position(ck_engine *engine, const signed char *cells, int color)
+{
+    if (!engine || (color != 0 && color != 1))
+        return -1;
+    if (!cells)
+    {
+        engine->mtx = Logic::start_mtx();
+    }
+    else
+    {
+        // Доска проверяется целиком до записи: отклонённый вызов не меняет позицию движка
+        vector<vector<POS_T>> mtx(8, vector<POS_T>(8, 0));
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int j = 0; j < 8; ++j)
+            {
+                POS_T cell = cells[i * 8 + j];
+                if (cell < 0 || cell > 4 || (cell && (i + j) % 2 == 0))
+                    return -1;
+                mtx[i][j] = cell;
+            }
+        }
+        engine->mtx = move(mtx);
+    }
+    engine->color = color;
+    engine->best.clear();
+    engine->lines.clear();
+    return 0;
+}
+
+int ck_engine_search(ck_engine *engine, const ck_limits *limits)
+{
+    if (!engine || !limits || !to_limits(limits).bounded())
+        return -1;
+    try
+    {
+        auto start = chrono::steady_clock::now();
+        engine->best.clear();
+        engine->logic.find_turns(engine->color, engine->mtx);
+        if (!engine->logic.turns.empty())
+            engine->best = engine->logic.search(engine->mtx, engine->color, to_limits(limits));
+        engine->stats.nodes = engine->logic.nodes;
+        engine->stats.time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        engine->stats.score = engine->best.empty() ? 0 : engine->logic.last_score;
+        engine->stats.level = engine->best.empty() ? -1 : engine->logic.last_level;
+    }
+    catch (...)
+    {
+        return -1;
+    }
+    return int(engine->best.size());
+}
+
+int ck_engine_best_move(const ck_engine *engine, ck_move *steps, int max_steps)
+{
+    if (!engine || (!steps && max_steps > 0))
+        return -1;
+    int n = min(max_steps, int(engine->best.size()));
+    for (int k = 0; k < n; ++k)
+        steps[k] = to_ck_move(engine->best[k]);
+    return n;
+}
+
+int ck_engine_get_stats(const ck_engine *engine, ck_stats *stats)
+{
+    if (!engine || !stats)
+        return -1;
+    *stats = engine->stats;
+    return 0;
+}
+
+int ck_engine_analyse(ck_engine *engine, const ck_limits *limits, int lines)
+{
+    if (!engine || !limits || lines < 1 || !to_limits(limits).bounded())
+        return -1;
+    try
+    {
+        auto start = chrono::steady_clock::now();
+        engine->lines = engine->logic.multi_pv(engine->mtx, engine->color, size_t(lines), to_limits(limits));
+        engine->best = engine->lines.empty() ? vector<move_pos>() : engine->lines[0].turn;
+        engine->stats.nodes = engine->logic.nodes;
+        engine->stats.time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        engine->stats.score = engine->logic.last_score;
+        engine->stats.level = engine->best.empty() ? -1 : engine->logic.last_level;
+    }
+    catch (...)
+    {
+        return -1;
+    }
+    return int(engine->lines.size());
+}
+
+int ck_engine_get_line(const ck_engine *engine, int index, ck_line *line, ck_move *steps, int max_steps)
+{
+    if (!engine || index < 0 || index >= int(engine->lines.size()) || (!steps && max_steps > 0))
+        return -1;
+    const pv_line &res = engine->lines[index];
+    if (line)
+        *line = ck_line{res.score, int(res.turn.size()), int(res.pv.size())};
+    int n = min(max_steps, int(res.pv.size()));
+    for (int k = 0; k < n; ++k)
+        steps[k] = to_ck_move(res.pv[k]);
+    return n;
+}
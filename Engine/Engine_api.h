@@ -0,0 +1,96 @@
+#pragma once
+/*
+ * C API движка шашек (правила, генерация ходов и поиск) без зависимости от SDL.
+ * Сборка библиотеки: g++ -std=c++17 -O2 -fPIC -shared Engine/Engine_api.cpp -o libcheckers_engine.so
+ *
+ * Доска - 64 клетки по строкам (cells[i * 8 + j] соответствует mtx[i][j]):
+ * 0 - пусто, 1 - белая шашка, 2 - черная шашка, 3 - белая дамка, 4 - черная дамка.
+ * Черные стоят в рядах 0-2, белые в рядах 5-7, белые ходят первыми. Цвет: 0 - белые, 1 - черные.
+ * Функции, возвращающие int, возвращают отрицательное значение при ошибке.
+ * Оценка - целое число (Engine/Score.h): 1200 * ln(соотношения материала), около 100 за лишнюю шашку,
+ * выигрыш через N ходов - 1000000 - N, проигрыш через N ходов - -(1000000 - N).
+ *
+ * CK_API_VERSION меняется при каждом несовместимом изменении структур или функций. Программа сравнивает
+ * CK_API_VERSION своего заголовка с ck_api_version() загруженной библиотеки и не работает с другой версией.
+ * Версия 2: score в ck_stats и ck_line - int (в версии 1 был double с отношением материала).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32) && defined(CHECKERS_ENGINE_BUILD)
+    #define CK_API __declspec(dllexport)
+#else
+    #define CK_API
+#endif
+
+#define CK_API_VERSION 2
+
+typedef struct ck_engine ck_engine;
+
+/* Один шаг хода, для серии взятий ход состоит из нескольких шагов */
+typedef struct ck_move
+{
+    signed char x, y;   /* откуда */
+    signed char x2, y2; /* куда */
+    signed char xb, yb; /* взятая фигура, -1 если взятия нет */
+} ck_move;
+
+/* Ограничения поиска, 0 - без ограничения. Хотя бы одно ограничение обязательно: у API нет остановки поиска,
+ * поэтому level < 0 вместе с nodes = 0 и time_ms = 0 отклоняется (ck_engine_search и ck_engine_analyse вернут -1) */
+typedef struct ck_limits
+{
+    int level;                /* уровень бота (глубина level + 1), меньше 0 - не ограничен */
+    unsigned long long nodes; /* максимальное количество узлов */
+    unsigned int time_ms;     /* максимальное время поиска */
+} ck_limits;
+
+/* Статистика последнего поиска */
+typedef struct ck_stats
+{
+    unsigned long long nodes; /* просмотренные узлы */
+    double time_ms;           /* время поиска */
+    int score;                /* оценка с точки зрения ходящего (как Logic::calc_score) */
+    int level;                /* полностью просчитанный уровень */
+} ck_stats;
+
+/* Версия C API библиотеки (CK_API_VERSION, с которым она собрана) */
+CK_API int ck_api_version(void);
+
+/* Создаёт движок с настройками из файла JSON (формат settings.json), NULL - settings.json игры */
+CK_API ck_engine *ck_engine_create(const char *settings_path);
+CK_API void ck_engine_destroy(ck_engine *engine);
+
+/* Меняет настройку, value - значение в формате JSON, например ck_engine_set_option(e, "Bot", "NoRandom", "true") */
+CK_API int ck_engine_set_option(ck_engine *engine, const char *section, const char *name, const char *value);
+
+/* Устанавливает позицию, cells == NULL - начальная расстановка. -1 - неверная клетка, позиция не меняется */
+CK_API int ck_engine_set_position(ck_engine *engine, const signed char *cells, int color);
+
+/* Поиск лучшего хода, возвращает количество шагов хода (0 - ходов нет), -1 - ошибка или поиск без ограничений */
+CK_API int ck_engine_search(ck_engine *engine, const ck_limits *limits);
+
+/* Копирует не более max_steps шагов лучшего хода, возвращает их количество */
+CK_API int ck_engine_best_move(const ck_engine *engine, ck_move *steps, int max_steps);
+
+CK_API int ck_engine_get_stats(const ck_engine *engine, ck_stats *stats);
+
+/* Строка анализа нескольких лучших ходов */
+typedef struct ck_line
+{
+    int score;      /* оценка хода с точки зрения ходящего */
+    int move_steps; /* количество шагов самого хода (главная линия начинается с них) */
+    int pv_steps;   /* количество шагов главной линии */
+} ck_line;
+
+/* Анализ нескольких лучших ходов (multi-PV): точные оценки и главные линии не более lines лучших ходов.
+ * Возвращает количество строк, лучший ход и статистика доступны как после ck_engine_search */
+CK_API int ck_engine_analyse(ck_engine *engine, const ck_limits *limits, int lines);
+
+/* Строка index (0 - лучший ход): копирует не более max_steps шагов главной линии, возвращает их количество */
+CK_API int ck_engine_get_line(const ck_engine *engine, int index, ck_line *line, ck_move *steps, int max_steps);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+
+#include "../Models/Move.h"
+
+// Геометрия доски N x N, вычисляемая при компиляции. Фигуры стоят только на тёмных клетках (i + j нечётно),
+// тёмные клетки нумеруются по строкам: номер (i, j) = i * N / 2 + j / 2 (для 8 x 8 как cell_index в Record.h).
+// Для каждой клетки и каждого из четырёх направлений хранится луч - клетки по диагонали до края доски,
+// поэтому ход шашки - первая клетка луча, взятие - вторая (через первую), а ходы и взятия дамки - проход
+// по лучу без проверок границ.
+// Направления: 0 - (-1, -1), 1 - (-1, +1), 2 - (+1, -1), 3 - (+1, +1); белые шашки ходят по 0 и 1, черные - по 2 и 3.
+template <int N> struct Geometry
+{
+    static_assert(N % 2 == 0 && N >= 6 && N <= 16, "board size must be even");
+
+    static constexpr int SIZE = N;
+    static constexpr int CELLS = N * N / 2;
+    static constexpr int START_ROWS = N / 2 - 1; // ряды шашек каждой стороны в начальной позиции
+    static constexpr int MAX_RAY = N - 1;
+
+    struct square
+    {
+        POS_T x = 0, y = 0;
+    };
+
+    struct tables
+    {
+        square cells[CELLS];                // координаты тёмной клетки по номеру
+        square ray[CELLS][4][MAX_RAY];      // лучи клетки по направлениям
+        int8_t ray_len[CELLS][4];           // длины лучей
+    };
+
+    static constexpr int cell(const POS_T i, const POS_T j)
+    {
+        return i * (N / 2) + j / 2;
+    }
+
+    static constexpr tables make_tables()
+    {
+        tables t{};
+        const int di[4] = {-1, -1, 1, 1}, dj[4] = {-1, 1, -1, 1};
+        for (int c = 0; c < CELLS; ++c)
+        {
+            const int i = c / (N / 2), j = (c % (N / 2)) * 2 + (i % 2 == 0);
+            t.cells[c].x = POS_T(i);
+            t.cells[c].y = POS_T(j);
+            for (int d = 0; d < 4; ++d)
+            {
+                int len = 0;
+                for (int i2 = i + di[d], j2 = j + dj[d]; i2 >= 0 && i2 < N && j2 >= 0 && j2 < N;
+                     i2 += di[d], j2 += dj[d])
+                {
+                    t.ray[c][d][len].x = POS_T(i2);
+                    t.ray[c][d][len].y = POS_T(j2);
+                    ++len;
+                }
+                t.ray_len[c][d] = int8_t(len);
+            }
+        }
+        return t;
+    }
+};
+
+// Таблицы геометрии, по одной на размер доски
+template <int N> inline constexpr typename Geometry<N>::tables GEOMETRY_TABLES = Geometry<N>::make_tables();
+
+// Русские шашки и международные (стоклеточные) шашки
+using Geometry_8 = Geometry<8>;
+using Geometry_10 = Geometry<10>;
@@ -0,0 +1,1117 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Project_path.h"
+#include "../Models/Record.h"
+#include "Batch.h"
+#include "Config.h"
+#include "Geometry.h"
+#include "Mcts.h"
+#include "Nnue.h"
+#include "Score.h"
+#include "Search_cache.h"
+#include "Search_trace.h"
+#include "Timeline.h"
+#include "Solver.h"
+#include "Transposition.h"
+
+const int MAX_LEVEL = 64; // Предел итеративного углубления, когда уровень не ограничен
+const size_t MULTI_PV_HASH_MB = 16; // Таблица транспозиций анализа multi_pv, если у бота своей нет (Bot.HashMB = 0)
+
+// Ограничения поиска Logic::search. 0 - без ограничения
+struct search_limits
+{
+    int level = 0;        // уровень бота (глубина просчёта level + 1), меньше 0 - не ограничен
+    size_t nodes = 0;     // максимальное количество узлов
+    unsigned time_ms = 0; // максимальное время поиска
+
+    // Поиск закончится сам. Без уровня, узлов и времени он идёт до MAX_LEVEL полным перебором, то есть
+    // фактически до stop_signal - так можно только при анализе с остановкой (go infinite)
+    bool bounded() const
+    {
+        return level >= 0 || nodes || time_ms;
+    }
+};
+
+// Уровень силы бота (Bot.WhiteBotSkill, Bot.BlackBotSkill): бюджет узлов на ход и случайный выбор среди почти
+// равных ходов. Время хода определяется числом узлов, а не глубиной, поэтому не зависит от позиции и компьютера
+struct skill_level
+{
+    size_t nodes;  // бюджет узлов на ход
+    size_t lines;  // из скольких лучших ходов выбирается ход
+    SCORE_T margin; // на сколько (Engine/Score.h) оценка выбранного хода может быть хуже лучшей
+};
+const int MAX_SKILL = 10;
+const skill_level SKILL_LEVELS[MAX_SKILL] = {{50, 4, 428},   {100, 4, 268},  {200, 3, 195},  {500, 3, 126},
+                                             {1000, 3, 62},  {2000, 2, 37},  {5000, 2, 24},  {10000, 2, 12},
+                                             {30000, 1, 0},  {100000, 1, 0}};
+
+// Строка анализа Logic::multi_pv
+struct pv_line
+{
+    vector<move_pos> turn; // ход (шаги серии взятий)
+    SCORE_T score = 0;     // оценка хода с точки зрения ходящего (Engine/Score.h)
+    vector<move_pos> pv;   // главная линия, начинается с хода
+};
+
+// Правила, генератор ходов и поиск на доске геометрии G (Engine/Geometry.h). Logic - русские шашки 8 x 8,
+// Logic_10 - те же правила на доске 10 x 10. Постоянный кэш и нейросеть есть только для 8 x 8
+template <class G> class Basic_logic
+{
+  public:
+    using geometry = G;
+
+    Basic_logic(Config *config) : config(config)
+    {
+        no_random = (*config)("Bot", "NoRandom");
+        const unsigned seed = initial_seed();
+        reseed(seed);
+        scoring_mode = (*config)("Bot", "BotScoringType");
+        optimization = (*config)("Bot", "Optimization");
+        const size_t hash_mb = (*config)("Bot", "HashMB");
+        if (hash_mb)
+            tt = make_shared<Transposition>(hash_mb);
+        if (scoring_mode == "NumberAndPotential")
+        {
+            potential_coef = 0.05;
+            q_coef = 5;
+            load_weights(project_path + string((*config)("Bot", "WeightsFile")));
+        }
+        if (scoring_mode == "NNUE")
+        {
+            const string nnue_path = project_path + string((*config)("Bot", "NnueFile"));
+            use_nnue = G::SIZE == 8 && nnue.load(nnue_path);
+            if (!use_nnue)
+            {
+                // Без сети бот играет с оценкой "NumberAndPotential"
+                ofstream fout(project_path + "log.txt", ios_base::app);
+                fout << "Error: can't load NNUE weights from " << nnue_path << ". NumberAndPotential is used" << endl;
+                fout.close();
+                potential_coef = 0.05;
+                q_coef = 5;
+            }
+        }
+        const string cache_file = (*config)("Bot", "CacheFile");
+        const size_t cache_mb = (*config)("Bot", "CacheMB");
+        if (!cache_file.empty() && cache_mb && G::SIZE == 8)
+        {
+            cache = make_shared<Search_cache>(project_path + cache_file, cache_mb, eval_fingerprint());
+            if (!cache->is_open())
+            {
+                ofstream fout(project_path + "log.txt", ios_base::app);
+                fout << "Error: can't open search cache " << project_path + cache_file << endl;
+                fout.close();
+                cache.reset();
+            }
+        }
+        const string trace_file = (*config)("Bot", "TraceFile");
+        if (!trace_file.empty())
+        {
+            trace = make_shared<Search_trace>(project_path + trace_file, size_t((*config)("Bot", "TraceMB")),
+                                              int((*config)("Bot", "TraceMaxDepth")), seed);
+            if (!trace->is_open())
+            {
+                ofstream fout(project_path + "log.txt", ios_base::app);
+                fout << "Error: can't open search trace " << project_path + trace_file << endl;
+                fout.close();
+                trace.reset();
+            }
+        }
+        solver_nodes = (*config)("Bot", "SolverNodes");
+        solver_plies = (*config)("Bot", "SolverPlies");
+        if (solver_nodes)
+            solver = make_shared<Solver<Basic_logic>>(size_t((*config)("Bot", "SolverMB")));
+        if (string((*config)("Bot", "Engine")) == "MCTS")
+        {
+            mcts = make_shared<Mcts<Basic_logic>>(size_t((*config)("Bot", "MctsMB")),
+                                            unsigned((*config)("Bot", "MctsThreads")), double((*config)("Bot", "MctsC")),
+                                            int((*config)("Bot", "MctsPlayoutPlies")));
+            mcts_playouts = (*config)("Bot", "MctsPlayouts");
+        }
+    }
+
+    // Загружает коэффициенты оценки, подобранные Tools/tuner.cpp. Если файла нет, остаются значения по умолчанию
+    void load_weights(const string &path)
+    {
+        ifstream fin(path);
+        if (!fin)
+            return;
+        json weights;
+        fin >> weights;
+        fin.close();
+        potential_coef = weights["PotentialCoef"];
+        q_coef = weights["QueenCoef"];
+    }
+
+    // Функция для поиска лучшей серии ходов для текущего игрока (цвета) на глубину Max_depth
+    vector<move_pos> find_best_turns(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        TIMELINE_ZONE("search");
+        nodes = 0;
+        vector<move_pos> res;
+        if (solve_turn(mtx, color, res))
+            return res;
+        if (mcts)
+            return mcts_turn(mtx, color, search_limits());
+        return find_best_turns_iter(mtx, color);
+    }
+
+    // Поиск с ограничениями по уровню, узлам и времени, а также с остановкой через stop_signal.
+    // При ограничениях по узлам, времени или остановке используется итеративное углубление до точного исчерпания
+    // бюджета: возвращается лучший ход последнего уровня, в том числе недосчитанного (ходы корня упорядочены по
+    // прошлому уровню), last_level - последний полностью просчитанный уровень
+    vector<move_pos> search(const vector<vector<POS_T>> &mtx, const bool color, const search_limits &limits)
+    {
+        TIMELINE_ZONE("search");
+        const int max_level = limits.level < 0 ? MAX_LEVEL : limits.level;
+        nodes = 0;
+        last_level = -1;
+        if (mcts)
+        {
+            vector<move_pos> res;
+            if (solve_turn(mtx, color, res))
+                return res;
+            return mcts_turn(mtx, color, limits);
+        }
+        if (!limits.nodes && !limits.time_ms && !stop_signal)
+        {
+            Max_depth = max_level;
+            last_level = max_level;
+            vector<move_pos> res;
+            if (solve_turn(mtx, color, res))
+                return res;
+            return find_best_turns_iter(mtx, color);
+        }
+
+        limited = true;
+        aborted = false;
+        max_nodes = limits.nodes;
+        has_deadline = limits.time_ms != 0;
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(limits.time_ms);
+        vector<vector<move_pos>> root;
+        vector<move_pos> path;
+        find_full_turns(mtx, color, path, root);
+        vector<move_pos> best, best_pv;
+        SCORE_T best_score = 0;
+        for (int level = 0; level <= max_level && !root.empty(); ++level)
+        {
+            TIMELINE_ZONE("search_iteration");
+            Max_depth = level;
+            auto res = multi_pv_iter(mtx, color, root, 1);
+            if (!res.empty())
+            {
+                // Лучший ход прошлого уровня просчитывается первым, поэтому ход, найденный до остановки
+                // на незаконченном уровне, не хуже его
+                best = res[0].turn;
+                best_score = res[0].score;
+                best_pv = res[0].pv;
+            }
+            if (aborted)
+                break;
+            last_level = level;
+            if (on_iteration)
+                on_iteration(level, best_score, nodes, best_pv);
+        }
+        limited = false;
+        if (best.empty())
+        {
+            // Не успели просчитать даже нулевой уровень
+            Max_depth = 0;
+            best = find_best_turns_iter(mtx, color);
+            best_score = last_score;
+            last_level = 0;
+            best_pv = last_pv;
+        }
+        last_score = best_score;
+        last_pv = best_pv;
+        return best;
+    }
+
+    // Анализ нескольких лучших ходов (multi-PV): не более lines ходов по убыванию оценки, у каждого точная оценка
+    // и главная линия. Ходы корня просчитываются по очереди с общей таблицей транспозиций (при Bot.HashMB = 0 создаётся своя
+    // и сохраняется для следующих вызовов), ход, не вошедший в lines лучших, отсекается по оценке худшего из них.
+    // Ограничения как в search, last_score и last_pv - оценка и линия лучшего хода
+    vector<pv_line> multi_pv(const vector<vector<POS_T>> &mtx, const bool color, const size_t lines,
+                             const search_limits &limits)
+    {
+        TIMELINE_ZONE("multi_pv");
+        const int max_level = limits.level < 0 ? MAX_LEVEL : limits.level;
+        const auto own_tt = tt;
+        const bool own_collect_pv = collect_pv;
+        if (!tt)
+            tt = analysis_tt ? analysis_tt : make_shared<Transposition>(MULTI_PV_HASH_MB);
+        collect_pv = true;
+        nodes = 0;
+        last_level = -1;
+        limited = limits.nodes || limits.time_ms || stop_signal;
+        aborted = false;
+        max_nodes = limits.nodes;
+        has_deadline = limits.time_ms != 0;
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(limits.time_ms);
+
+        vector<vector<move_pos>> root;
+        vector<move_pos> path;
+        find_full_turns(mtx, color, path, root);
+        vector<pv_line> best;
+        for (int level = limited ? 0 : max_level; level <= max_level && !root.empty(); ++level)
+        {
+            TIMELINE_ZONE("search_iteration");
+            Max_depth = level;
+            auto res = multi_pv_iter(mtx, color, root, max<size_t>(lines, 1));
+            if (aborted)
+                break;
+            best = res;
+            last_level = level;
+        }
+        limited = false;
+        if (best.empty() && !root.empty())
+        {
+            // Не успели просчитать даже нулевой уровень
+            Max_depth = 0;
+            best = multi_pv_iter(mtx, color, root, max<size_t>(lines, 1));
+            last_level = 0;
+        }
+        if (!own_tt)
+            analysis_tt = tt;
+        tt = own_tt;
+        collect_pv = own_collect_pv;
+        last_score = best.empty() ? 0 : best[0].score;
+        last_pv = best.empty() ? vector<move_pos>() : best[0].pv;
+        return best;
+    }
+
+    // Ход бота уровня силы skill (1..MAX_SKILL): поиск с бюджетом узлов SKILL_LEVELS, затем случайный ход из lines
+    // лучших, оценка которых не более чем на margin ниже лучшей. Случайность задаётся Bot.Seed и не зависит
+    // от стандартной библиотеки, поэтому партия с тем же Seed повторяется на любом компьютере
+    vector<move_pos> find_skill_turns(const vector<vector<POS_T>> &mtx, const bool color, const int skill)
+    {
+        const skill_level &level = SKILL_LEVELS[min(max(skill, 1), MAX_SKILL) - 1];
+        search_limits limits;
+        limits.level = -1;
+        limits.nodes = level.nodes;
+        if (level.lines <= 1)
+            return search(mtx, color, limits);
+        auto lines = multi_pv(mtx, color, level.lines, limits);
+        if (lines.empty())
+            return {};
+        size_t count = 1;
+        while (count < lines.size() && lines[count].score >= lines[0].score - level.margin)
+            ++count;
+        const auto &line = lines[skill_eng() % count];
+        last_score = line.score;
+        last_pv = line.pv;
+        return line.turn;
+    }
+
+    // Острая позиция: у ходящего есть взятие или противник угрожает взятием
+    bool is_sharp(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        find_turns(color, mtx);
+        if (have_beats)
+            return true;
+        find_turns(!color, mtx);
+        return have_beats;
+    }
+
+    // Все ходы стороны color целиком: серия взятий - один ход из нескольких шагов
+    void find_full_turns(const vector<vector<POS_T>> &mtx, const bool color, vector<move_pos> &path,
+                         vector<vector<move_pos>> &res)
+    {
+        if (path.empty())
+        {
+            find_turns(color, mtx);
+        }
+        else
+        {
+            find_turns(path.back().x2, path.back().y2, mtx);
+            if (!have_beats)
+            {
+                res.push_back(path);
+                return;
+            }
+        }
+        auto now_turns = turns;
+        auto now_have_beats = have_beats;
+        for (const auto &turn : now_turns)
+        {
+            path.push_back(turn);
+            if (now_have_beats)
+                find_full_turns(make_turn(mtx, turn), color, path, res);
+            else
+                res.push_back(path);
+            path.pop_back();
+        }
+    }
+
+private:
+    // Ход движка MCTS (Bot.Engine): узлы - партии, ограничения как в search, уровень не учитывается.
+    // Без ограничений по узлам и времени играется Bot.MctsPlayouts партий; stop_signal только прерывает поиск
+    vector<move_pos> mcts_turn(const vector<vector<POS_T>> &mtx, const bool color, const search_limits &limits)
+    {
+        size_t playouts = limits.nodes;
+        if (!limits.nodes && !limits.time_ms)
+            playouts = mcts_playouts;
+        auto res = mcts->search(*this, mtx, color, playouts, limits.time_ms, stop_signal, skill_eng());
+        nodes += mcts->playouts;
+        last_score = mcts->score;
+        last_pv = mcts->pv;
+        last_level = max(mcts->depth - 1, 0);
+        if (on_iteration)
+            on_iteration(last_level, last_score, nodes, last_pv);
+        return res;
+    }
+
+    // Решатель тактики (Bot.SolverNodes) в острой позиции: если форсированный выигрыш за SolverPlies полуходов
+    // доказан, res - первый ход выигрышной линии, last_score - выигрыш через число ходов линии, last_pv - вся линия
+    bool solve_turn(const vector<vector<POS_T>> &mtx, const bool color, vector<move_pos> &res)
+    {
+        if (!solver || !is_sharp(mtx, color))
+            return false;
+        vector<move_pos> line;
+        const auto result = solver->solve(*this, mtx, color, solver_plies, solver_nodes, line);
+        nodes += solver->nodes;
+        if (result != Solver<Basic_logic>::WIN)
+            return false;
+        vector<vector<move_pos>> root;
+        vector<move_pos> path;
+        find_full_turns(mtx, color, path, root);
+        for (const auto &turn : root)
+        {
+            if (turn.size() <= line.size() && equal(turn.begin(), turn.end(), line.begin()))
+            {
+                res = turn;
+                last_score = win_in(count_turns(line));
+                last_pv = line;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Число ходов в линии шагов: шаг продолжает ход, если предыдущий шаг - взятие и он начинается там, где тот закончился
+    static int count_turns(const vector<move_pos> &line)
+    {
+        int res = 0;
+        for (size_t k = 0; k < line.size(); ++k)
+            res += k == 0 || line[k - 1].xb == -1 || line[k].x != line[k - 1].x2 || line[k].y != line[k - 1].y2;
+        return res;
+    }
+
+    // Один проход multi_pv на глубину Max_depth. Ходы root переупорядочиваются по оценкам для следующего уровня.
+    // При остановке поиска возвращаются ходы, полностью просчитанные до неё
+    vector<pv_line> multi_pv_iter(const vector<vector<POS_T>> &mtx, const bool color, vector<vector<move_pos>> &root,
+                                  const size_t lines)
+    {
+        vector<pv_line> res;
+        vector<SCORE_T> scores(root.size());
+        if (trace)
+            trace->search(Transposition::hash(mtx, color, 0), Max_depth);
+        for (size_t k = 0; k < root.size(); ++k)
+        {
+            // Пока не набрано lines ходов - полное окно, затем ход должен оказаться лучше худшего из них
+            const SCORE_T alpha = res.size() < lines ? -INF : res.back().score;
+            ply = 0;
+            if (use_nnue)
+            {
+                acc_stack.resize(max<size_t>(acc_stack.size(), 1));
+                nnue.refresh(acc_stack[0], mtx);
+            }
+            auto cur = mtx;
+            for (const auto &step : root[k])
+            {
+                make_ply(cur, step);
+                cur = make_turn(cur, step);
+            }
+            const SCORE_T score = find_best_turns_rec(cur, 1 - color, 0, alpha);
+            const size_t child_ply = ply;
+            ply = 0;
+            // Остановка: возвращаются ходы, просчитанные до неё
+            if (aborted)
+                return res;
+            scores[k] = score;
+            if (res.size() == lines && score <= alpha)
+                continue;
+            pv_line line;
+            line.turn = root[k];
+            line.score = score;
+            line.pv = root[k];
+            if (collect_pv)
+                line.pv.insert(line.pv.end(), pv_table[child_ply].begin(), pv_table[child_ply].end());
+            auto pos = upper_bound(res.begin(), res.end(), score,
+                                   [](const SCORE_T s, const pv_line &l) { return s > l.score; });
+            res.insert(pos, line);
+            if (res.size() > lines)
+                res.pop_back();
+        }
+        vector<size_t> order(root.size());
+        for (size_t k = 0; k < order.size(); ++k)
+            order[k] = k;
+        stable_sort(order.begin(), order.end(),
+                    [&scores](const size_t a, const size_t b) { return scores[a] > scores[b]; });
+        vector<vector<move_pos>> sorted;
+        for (size_t k : order)
+            sorted.push_back(root[k]);
+        root = sorted;
+        return res;
+    }
+
+    // Настройки, от которых зависит результат поиска: при их изменении постоянный кэш создаётся заново
+    uint64_t eval_fingerprint() const
+    {
+        stringstream ss;
+        ss << scoring_mode << ' ' << optimization << ' ' << potential_coef << ' ' << q_coef << ' ' << use_nnue;
+        if (use_nnue)
+        {
+            ifstream fin(project_path + string((*config)("Bot", "NnueFile")), ios::binary);
+            ss << ' ' << fin.rdbuf();
+        }
+        uint64_t h = 14695981039346656037ull; // FNV-1a
+        for (char c : ss.str())
+            h = (h ^ uint8_t(c)) * 1099511628211ull;
+        return h;
+    }
+
+    // Ход по клеткам из постоянного кэша, проверенный генератором ходов. Пустой - если такого хода нет
+    vector<move_pos> turn_from_cells(const vector<vector<POS_T>> &mtx, const bool color, const vector<uint8_t> &cells)
+    {
+        vector<move_pos> res;
+        auto cur = mtx;
+        for (size_t k = 1; k < cells.size(); ++k)
+        {
+            auto [x, y] = cell_coords(cells[k - 1]);
+            auto [x2, y2] = cell_coords(cells[k]);
+            if (k == 1)
+            {
+                find_turns(color, cur);
+            }
+            else
+            {
+                find_turns(x, y, cur);
+                if (!have_beats)
+                    return {};
+            }
+            auto it = find_if(turns.begin(), turns.end(), [&](const move_pos &turn) {
+                return turn.x == x && turn.y == y && turn.x2 == x2 && turn.y2 == y2;
+            });
+            if (it == turns.end())
+                return {};
+            res.push_back(*it);
+            cur = make_turn(cur, *it);
+        }
+        return res;
+    }
+
+    // Один проход поиска на глубину Max_depth (узлы добавляются к nodes).
+    // Без ограничений поиска результат берётся из постоянного кэша и записывается в него
+    vector<move_pos> find_best_turns_iter(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        if (cache && !limited)
+        {
+            SCORE_T score;
+            vector<uint8_t> cells;
+            if (cache->probe(mtx, color, Max_depth, score, cells))
+            {
+                auto res = turn_from_cells(mtx, color, cells);
+                if (!res.empty())
+                {
+                    last_score = score;
+                    last_pv = res;
+                    return res;
+                }
+            }
+        }
+        next_move.clear(); // Очистка вектора для хранения след. хода
+        next_best_state.clear(); // Очистка вектора для хранения след. состояния
+
+        // Поиск первого лучшего хода, начиная с переданного состояния доски
+        if (trace)
+            trace->search(Transposition::hash(mtx, color, 0), Max_depth);
+        find_turns(color, mtx);
+        ply = 0;
+        if (use_nnue)
+        {
+            acc_stack.resize(max<size_t>(acc_stack.size(), 1));
+            nnue.refresh(acc_stack[0], mtx);
+        }
+        last_score = find_first_best_turn(mtx, color, -1, -1, 0);
+        if (collect_pv)
+            last_pv = pv_table[0];
+
+        vector<move_pos> res; // Вектор для хранения результата
+        int state = 0; // Начальное состояние
+
+        // Построение цепочки ходов на основе найденных лучших состояний
+        do {
+            res.push_back(next_move[state]); // Добавление хода в результат
+            state = next_best_state[state]; // Переход к следующему состоянию
+        } while (state != -1 && next_move[state].x != -1); // Пока есть следующие ходы
+
+        if (cache && !limited)
+        {
+            vector<uint8_t> cells(1, cell_index(res[0].x, res[0].y));
+            for (const auto &step : res)
+                cells.push_back(cell_index(step.x2, step.y2));
+            cache->store(mtx, color, Max_depth, last_score, cells);
+        }
+        return res;
+        
+    }
+
+public:
+    // Переинициализация генератора случайных чисел (разные партии в параллельных потоках)
+    void reseed(const unsigned seed)
+    {
+        rand_eng.seed(seed);
+        skill_eng.seed(seed);
+    }
+
+    // Начальное значение генератора: Seed, время запуска или 0 для NoRandom
+    unsigned initial_seed() const
+    {
+        const unsigned seed = (*config)("Bot", "Seed");
+        return !no_random ? (seed ? seed : unsigned(time(0))) : 0;
+    }
+
+    // Новая партия с теми же настройками: бот ведёт себя как только что созданный, но таблицы, сеть и кэш
+    // не выделяются и не загружаются заново (быстрый REPLAY)
+    void new_game()
+    {
+        reseed(initial_seed());
+        if (tt)
+            tt->clear();
+        if (analysis_tt)
+            analysis_tt->clear();
+        if (mcts)
+            mcts->clear();
+        nodes = 0;
+        last_score = 0;
+        last_level = -1;
+        last_pv.clear();
+    }
+
+    // Начальная расстановка фигур (как Board::make_start_mtx)
+    static vector<vector<POS_T>> start_mtx()
+    {
+        vector<vector<POS_T>> mtx(G::SIZE, vector<POS_T>(G::SIZE, 0));
+        for (const auto &sq : GEOMETRY_TABLES<G::SIZE>.cells)
+        {
+            if (sq.x < G::START_ROWS) // Верхние ряды (черные шашки)
+                mtx[sq.x][sq.y] = 2;
+            if (sq.x >= G::SIZE - G::START_ROWS) // Нижние ряды (белые шашки)
+                mtx[sq.x][sq.y] = 1;
+        }
+        return mtx;
+    }
+
+    // Функция для выполнения хода на доске (без изменения оригинальной доски)
+    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const
+    {
+        if (turn.xb != -1) // Если ход включает взятие фигуры
+            mtx[turn.xb][turn.yb] = 0; // Удаляем взятую фигуру
+
+        // Превращение в дамку, если фигура дошла до последней линии
+        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == G::SIZE - 1))
+            mtx[turn.x][turn.y] += 2; // Превращаем фигуру в дамку
+        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y]; // Перемещаем фигуру на новую позицию
+        mtx[turn.x][turn.y] = 0; // Очищаем старую позицию
+        return mtx; // Возвращаем новое состояние доски
+    }
+
+    // Функция для вычисления оценки текущего состояния доски
+    // Оценка (Engine/Score.h): логарифм отношения материала, WIN_SCORE / -WIN_SCORE, если фигур не осталось
+    SCORE_T calc_score(const vector<vector<POS_T>> &mtx, const bool first_bot_color) const
+    {
+        if (use_nnue)
+            return calc_nnue_score(first_bot_color);
+        // Счетчики для белых и черных фигур и дамок
+        double w = 0, wq = 0, b = 0, bq = 0; 
+        for (const auto &sq : GEOMETRY_TABLES<G::SIZE>.cells) // Только тёмные клетки
+        {
+            const POS_T i = sq.x, j = sq.y;
+            w += (mtx[i][j] == 1); // Считаем белые фигуры
+            wq += (mtx[i][j] == 3); // Считаем белые дамки
+            b += (mtx[i][j] == 2); // Считаем черные фигуры
+            bq += (mtx[i][j] == 4); // Считаем черные дамки
+            w += potential_coef * (mtx[i][j] == 1) * (G::SIZE - 1 - i); // Учитываем потенциал белых фигур
+            b += potential_coef * (mtx[i][j] == 2) * (i); // Учитываем потенциал черных фигур
+        }
+        if (!first_bot_color) // Если бот играет за черных, меняем местами счетчики
+        {
+            swap(b, w);
+            swap(bq, wq);
+        }
+        if (w + wq == 0) // Если белых фигур не осталось, возвращаем максимальное значение
+            return WIN_SCORE;
+        if (b + bq == 0) // Если черных фигур не осталось, возвращаем минимальное значение
+            return -WIN_SCORE;
+        return ratio_score((b + bq * q_coef) / (w + wq * q_coef)); // Возвращаем значение
+    }
+
+    // Оценка позиции вне поиска (calc_score для стороны color), для нейросети аккумулятор строится заново
+    SCORE_T evaluate(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        if (use_nnue)
+        {
+            ply = 0;
+            acc_stack.resize(max<size_t>(acc_stack.size(), 1));
+            nnue.refresh(acc_stack[0], mtx);
+        }
+        return calc_score(mtx, color);
+    }
+
+    // Пакетные генерация ходов и оценка (Engine/Batch.h) для доски 8 x 8: количество шагов-ходов, обязательное
+    // взятие и calc_score с точки зрения ходящего для каждой позиции. Нейросеть оценивает позиции по одной
+    void evaluate_batch(const batch_positions &pos, batch_results &res, const Batch::kernel k = Batch::best_kernel())
+    {
+        static_assert(G::SIZE == 8, "batch kernels work on 8 x 8 masks");
+        Batch::run(pos, res, potential_coef, q_coef, k);
+        if (!use_nnue)
+            return;
+        for (size_t i = 0; i < pos.size(); ++i)
+        {
+            position_record rec{};
+            rec.white = pos.white[i];
+            rec.black = pos.black[i];
+            rec.kings = pos.kings[i];
+            res.score[i] = evaluate(unpack_board(rec), pos.side[i]);
+        }
+    }
+
+private:
+    // Проверка ограничений поиска, время проверяется раз в 1024 узла
+    bool out_of_limits()
+    {
+        if (!aborted && ((max_nodes && nodes >= max_nodes) || (stop_signal && *stop_signal) ||
+                         (has_deadline && (nodes & 1023) == 0 && chrono::steady_clock::now() >= deadline)))
+            aborted = true;
+        return aborted;
+    }
+
+    // Оценка нейросетью по аккумулятору текущей позиции поиска, в той же шкале, что и calc_score
+    SCORE_T calc_nnue_score(const bool first_bot_color) const
+    {
+        const auto &acc = acc_stack[ply];
+        int own = first_bot_color ? acc.black : acc.white;
+        int opp = first_bot_color ? acc.white : acc.black;
+        if (opp == 0)
+            return WIN_SCORE;
+        if (own == 0)
+            return -WIN_SCORE;
+        // Выход сети - логарифм отношения материала белых к черным, умноженный на OUTPUT_SCALE
+        double value = double(nnue.evaluate(acc)) / Nnue::OUTPUT_SCALE;
+        return log_ratio_score(first_bot_color ? -value : value);
+    }
+
+    // Переход на следующий полуход поиска: инкрементальное обновление аккумулятора нейросети
+    void make_ply(const vector<vector<POS_T>> &mtx, const move_pos &turn)
+    {
+        if (use_nnue)
+        {
+            if (ply + 1 == acc_stack.size())
+                acc_stack.emplace_back();
+            nnue.update(acc_stack[ply], acc_stack[ply + 1], mtx, turn);
+        }
+        if (trace)
+            trace_turn = turn;
+        ++ply;
+    }
+
+    // Возврат к позиции до хода
+    void unmake_ply()
+    {
+        --ply;
+    }
+
+    // Очищает главную линию текущего полухода (при входе в узел)
+    void clear_pv()
+    {
+        if (pv_table.size() <= ply + 1)
+            pv_table.resize(ply + 2);
+        pv_table[ply].clear();
+    }
+
+    // Главная линия узла: лучший ход и линия его потомка
+    void update_pv(const move_pos &turn)
+    {
+        auto &pv = pv_table[ply];
+        pv.assign(1, turn);
+        pv.insert(pv.end(), pv_table[ply + 1].begin(), pv_table[ply + 1].end());
+    }
+
+    // Рекурсивная функция для поиска лучшего хода
+    SCORE_T find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state,
+                                 SCORE_T alpha = -INF)
+    {
+        if (limited && out_of_limits())
+            return 0;
+        ++nodes;
+        if (collect_pv)
+            clear_pv();
+        next_move.emplace_back(-1, -1, -1, -1); // Добавление пустого хода
+        next_best_state.push_back(-1); // Добавление пустого состояния
+
+        // Поиск ходов для текущей позиции
+        if (state != 0) {
+            find_turns(x, y, mtx);
+        }
+        
+        auto now_turns = turns; // Сохранение текущих ходов
+        auto now_have_beats = have_beats; // Сохранение флага наличия взятий
+
+        if (!now_have_beats && state != 0) {
+            return find_best_turns_rec(mtx, 1 - color, 0, alpha);
+        }
+        SCORE_T best_score = -INF; // Лучшая оценка
+
+        // Рекурсивный поиск ходов
+        for (auto turn : now_turns) {
+            size_t new_state = next_move.size(); // Новое состояние
+            SCORE_T score;
+            make_ply(mtx, turn);
+            if (now_have_beats) {
+                score = find_first_best_turn(make_turn(mtx, turn), color, turn.x2, turn.y2, new_state, best_score);
+            } 
+            else {
+                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, 0, best_score);
+            }
+            unmake_ply();
+            // Нашли лучшую оптиму
+            if (score > best_score) {
+                if (collect_pv)
+                    update_pv(turn);
+                best_score = score;
+                next_move[state] = turn; // Сохранение лучшего хода
+                next_best_state[state] = (now_have_beats ? new_state : -1); // Сохранение следующего состояния
+            }
+        }
+
+        return best_score;
+        
+        // now_have_beats && state == 0;
+        // !now_have_beats && state == 0;
+        // now_have_beats && state != 0;
+        // !now_have_beats && state != 0;
+
+    }
+
+    // Узел поиска; при записи дерева (Bot.TraceFile) вход и выход узла пишутся в файл
+    SCORE_T find_best_turns_rec(const vector<vector<POS_T>> &mtx, const bool color, const size_t depth,
+                                const SCORE_T alpha = -INF, const SCORE_T beta = INF, const POS_T x = -1,
+                                const POS_T y = -1)
+    {
+        if (!trace || !trace->traced(int(depth)))
+            return search_node(mtx, color, depth, alpha, beta, x, y);
+        const bool has_turn = ply > 0;
+        trace->enter(int(depth), ply, color, has_turn ? G::cell(trace_turn.x, trace_turn.y) : 0xff,
+                     has_turn ? G::cell(trace_turn.x2, trace_turn.y2) : 0xff, alpha, beta);
+        const uint8_t parent_flags = trace_flags;
+        trace_flags = 0;
+        const SCORE_T score = search_node(mtx, color, depth, alpha, beta, x, y);
+        trace->exit(int(depth), ply, color, score, trace_flags);
+        trace_flags = parent_flags;
+        return score;
+    }
+
+    // Рекурсивная функция для поиска лучших ходов с использованием альфа-бета отсечения
+    // Выигрыш и проигрыш на глубине depth - через depth + 1 ходов от корня
+    SCORE_T search_node(const vector<vector<POS_T>> &mtx, const bool color, const size_t depth, SCORE_T alpha,
+                        SCORE_T beta, const POS_T x, const POS_T y)
+    {
+        if (limited && out_of_limits())
+        {
+            trace_flags |= trace_record::ABORTED;
+            return 0;
+        }
+        ++nodes;
+        if (collect_pv)
+            clear_pv();
+        // Возврат оценки, если достигнута максимальная глубина
+        if (depth == Max_depth) {
+            trace_flags |= trace_record::LEAF;
+            const SCORE_T score = calc_score(mtx, (depth % 2 == color));
+            return is_win(score) ? win_in(int(depth) + 1) : (is_loss(score) ? loss_in(int(depth) + 1) : score);
+        }
+
+        // Таблица транспозиций: только в начале хода, не внутри серии взятий
+        uint64_t key = 0;
+        const SCORE_T alpha_orig = alpha, beta_orig = beta;
+        Transposition::entry hint;
+        if (tt && x == -1)
+        {
+            key = Transposition::hash(mtx, color, depth % 2 == color);
+            const bool found = tt->probe(key, hint);
+            hint.score = score_from_tt(hint.score, int(depth) + 1);
+            if (found && hint.draft >= Max_depth - int(depth) &&
+                (hint.flag == Transposition::EXACT || (hint.flag == Transposition::LOWER && hint.score > beta) ||
+                 (hint.flag == Transposition::UPPER && hint.score < alpha)))
+            {
+                trace_flags |= trace_record::TT_HIT;
+                return hint.score;
+            }
+        }
+
+        // Поиск ходов для конкретной позиции
+        if (x != -1) {
+            find_turns(x, y, mtx); 
+        }
+        else {
+            find_turns(color, mtx); // Поиск ходов для всех фигур цвета
+        }
+        auto now_turns = turns; // Сохранение текущих ходов
+        auto now_have_beats = have_beats; // Сохранение флага наличия взятий
+        if (key && hint.from != -1)
+        {
+            // Лучший ход из таблицы просчитывается первым
+            for (size_t k = 1; k < now_turns.size(); ++k)
+            {
+                if (G::cell(now_turns[k].x, now_turns[k].y) == hint.from &&
+                    G::cell(now_turns[k].x2, now_turns[k].y2) == hint.to)
+                {
+                    rotate(now_turns.begin(), now_turns.begin() + k, now_turns.begin() + k + 1);
+                    break;
+                }
+            }
+        }
+
+        // Рекурсивный поиск ходов
+        if (!now_have_beats && x != -1) {
+            return find_best_turns_rec(mtx, 1 - color, depth + 1, alpha, beta);
+        }
+
+        // Возврат оценки, если ходов нет
+        if (turns.empty()) {
+            return (depth % 2 ? loss_in(int(depth) + 1) : win_in(int(depth) + 1));
+        }
+
+        SCORE_T min_score = INF; // Минимальная оценка
+        SCORE_T max_score = -INF; // Максимальная оценка
+        move_pos best_turn(-1, -1, -1, -1);
+        for (auto turn : now_turns) {
+            SCORE_T score;
+            make_ply(mtx, turn);
+            if (now_have_beats) {
+                score = find_best_turns_rec(make_turn(mtx, turn), color, depth, alpha, beta, turn.x2, turn.y2);
+            }
+            else {
+                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, depth + 1, alpha, beta);
+            }
+            unmake_ply();
+            if (depth % 2 ? score > max_score : score < min_score)
+            {
+                best_turn = turn;
+                if (collect_pv)
+                    update_pv(turn);
+            }
+
+            min_score = min(min_score, score);
+            max_score = max(max_score, score);
+            // alpha-beta cutter
+
+            // Обновление альфа
+            if (depth % 2) {
+                alpha = max(alpha, max_score); 
+            }
+
+            // Обновление бета
+            else {
+                beta = min(beta, min_score); 
+            }
+
+            // Прерывание, если альфа больше бета
+            if (optimization != "O0" && alpha > beta) {
+                trace_flags |= trace_record::CUTOFF;
+                break; 
+            }
+
+            // Возврат оценки при равенстве альфа и бета
+            if (optimization == "O2" && alpha == beta) {
+                trace_flags |= trace_record::CUTOFF;
+                return (depth % 2 ? max_score + 1 : min_score - 1);
+            }
+        }
+
+        const SCORE_T res = (depth % 2 ? max_score : min_score);
+        if (key && !aborted)
+        {
+            Transposition::entry e;
+            e.score = score_to_tt(res, int(depth) + 1);
+            e.draft = Max_depth - int(depth);
+            e.flag = res < alpha_orig ? Transposition::UPPER
+                                      : (res > beta_orig ? Transposition::LOWER : Transposition::EXACT);
+            e.from = G::cell(best_turn.x, best_turn.y);
+            e.to = G::cell(best_turn.x2, best_turn.y2);
+            tt->store(key, e);
+        }
+        return res; // Возврат лучшей оценки
+        
+    }
+
+public:
+    // Поиск всех возможных ходов для фигур определенного цвета
+    void find_turns(const bool color, const vector<vector<POS_T>> &mtx)
+    {
+        vector<move_pos> res_turns; // Вектор для хранения найденных ходов
+        bool have_beats_before = false; // Флаг, указывающий есть ли взятия в текущем ходе
+        for (const auto &sq : GEOMETRY_TABLES<G::SIZE>.cells) // Тёмные клетки по строкам
+        {
+            const POS_T i = sq.x, j = sq.y;
+            if (mtx[i][j] && mtx[i][j] % 2 != color) // Проверка, что фигура принадлежит противнику
+            {
+                find_turns(i, j, mtx); // Поиск ходов для фигуры
+                if (have_beats && !have_beats_before) // Если найдены взятия и до этого их не было
+                {
+                    have_beats_before = true;
+                    res_turns.clear(); // Очищаем предыдущие ходы
+                }
+                if ((have_beats_before && have_beats) || !have_beats_before)
+                {
+                    res_turns.insert(res_turns.end(), turns.begin(), turns.end());
+                }
+            }
+        }
+        turns = res_turns;
+        if (!no_random) // Без случайности порядок ходов фиксирован и не зависит от реализации стандартной библиотеки
+            shuffle(turns.begin(), turns.end(), rand_eng);
+        have_beats = have_beats_before;
+    }
+
+    // Поиск ходов для фигуры на конкретной клетке: проход по лучам клетки из таблиц геометрии
+    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx)
+    {
+        turns.clear();
+        have_beats = false;
+        POS_T type = mtx[x][y];
+        const auto &rays = GEOMETRY_TABLES<G::SIZE>.ray[G::cell(x, y)];
+        const auto &lens = GEOMETRY_TABLES<G::SIZE>.ray_len[G::cell(x, y)];
+        // check beats
+        switch (type)
+        {
+        case 1:
+        case 2:
+            // check pieces: через первую клетку луча на вторую
+            for (int d = 0; d < 4; ++d)
+            {
+                if (lens[d] < 2)
+                    continue;
+                const auto &b = rays[d][0], &to = rays[d][1];
+                if (mtx[to.x][to.y] || !mtx[b.x][b.y] || mtx[b.x][b.y] % 2 == type % 2)
+                    continue;
+                turns.emplace_back(x, y, to.x, to.y, b.x, b.y);
+            }
+            break;
+        default:
+            // check queens: после единственной фигуры противника на луче - любая свободная клетка до препятствия
+            for (int d = 0; d < 4; ++d)
+            {
+                POS_T xb = -1, yb = -1;
+                for (int k = 0; k < lens[d]; ++k)
+                {
+                    const auto &sq = rays[d][k];
+                    if (mtx[sq.x][sq.y])
+                    {
+                        if (mtx[sq.x][sq.y] % 2 == type % 2 || xb != -1)
+                            break;
+                        xb = sq.x;
+                        yb = sq.y;
+                    }
+                    else if (xb != -1)
+                    {
+                        turns.emplace_back(x, y, sq.x, sq.y, xb, yb);
+                    }
+                }
+            }
+            break;
+        }
+        // check other turns
+        if (!turns.empty())
+        {
+            have_beats = true;
+            return;
+        }
+        switch (type)
+        {
+        case 1:
+        case 2:
+            // check pieces: белые ходят по направлениям 0 и 1, черные - по 2 и 3
+            for (int d = (type % 2 ? 0 : 2), last = d + 2; d < last; ++d)
+            {
+                if (lens[d] && !mtx[rays[d][0].x][rays[d][0].y])
+                    turns.emplace_back(x, y, rays[d][0].x, rays[d][0].y);
+            }
+            break;
+        default:
+            // check queens
+            for (int d = 0; d < 4; ++d)
+            {
+                for (int k = 0; k < lens[d] && !mtx[rays[d][k].x][rays[d][k].y]; ++k)
+                    turns.emplace_back(x, y, rays[d][k].x, rays[d][k].y);
+            }
+            break;
+        }
+    }
+
+  public:
+    vector<move_pos> turns;
+    bool have_beats;
+    int Max_depth; // Максимальная глубина рекурсии для поиска лучшего хода
+    SCORE_T last_score = 0; // Оценка лучшего хода последнего поиска (с точки зрения ходящего)
+    size_t nodes = 0; // Количество узлов, просмотренных последним поиском
+    int last_level = -1; // Последний полностью просчитанный уровень в search
+    const atomic<bool> *stop_signal = nullptr; // Внешний флаг остановки поиска (протокол, API)
+    bool collect_pv = false; // Собирать главную линию (last_pv) во время поиска
+    vector<move_pos> last_pv; // Главная линия последнего поиска: шаги ходов обеих сторон
+    // Вызывается в search после каждого полностью просчитанного уровня: уровень, оценка, узлы, главная линия
+    function<void(int, SCORE_T, size_t, const vector<move_pos> &)> on_iteration;
+    // Таблица транспозиций (Bot.HashMB), может быть общей для нескольких Logic в разных потоках
+    shared_ptr<Transposition> tt;
+    // Постоянный кэш результатов поиска в файле (Bot.CacheFile)
+    shared_ptr<Search_cache> cache;
+    // Решатель тактики (Bot.SolverNodes), nullptr - выключен
+    shared_ptr<Solver<Basic_logic>> solver;
+    // Запись дерева поиска (Bot.TraceFile), nullptr - выключена
+    shared_ptr<Search_trace> trace;
+    // Движок MCTS вместо альфа-бета (Bot.Engine = "MCTS"), nullptr - альфа-бета. Дерево сохраняется между ходами
+    shared_ptr<Mcts<Basic_logic>> mcts;
+
+  private:
+    default_random_engine rand_eng; // Генератор случайных чисел для перемешивания ходов
+    mt19937 skill_eng; // Выбор хода уровня силы (mt19937 одинаков во всех стандартных библиотеках)
+    shared_ptr<Transposition> analysis_tt; // Таблица multi_pv, если у бота своей нет (сохраняется между вызовами)
+    bool no_random = false; // Детерминированный бот (NoRandom)
+    size_t solver_nodes = 0; // Бюджет узлов решателя на ход (SolverNodes)
+    int solver_plies = 0; // Глубина решателя в полуходах (SolverPlies)
+    size_t mcts_playouts = 0; // Партий MCTS на ход без других ограничений (MctsPlayouts)
+    string scoring_mode; // Режим оценки ("NumberAndPotential")
+    double potential_coef = 0; // Вес одного ряда продвижения шашки ("NumberAndPotential")
+    double q_coef = 4; // Коэффициент для дамок
+    bool use_nnue = false; // Оценка нейросетью ("NNUE" и файл весов загружен)
+    Nnue nnue; // Веса нейросети
+    vector<Nnue::accumulator> acc_stack; // Аккумуляторы позиций на пути поиска
+    size_t ply = 0; // Полуход поиска от корня (индекс аккумулятора и главной линии)
+    vector<vector<move_pos>> pv_table; // Главные линии узлов на пути поиска
+    move_pos trace_turn = move_pos(-1, -1, -1, -1); // Последний ход поиска (для записи дерева)
+    uint8_t trace_flags = 0; // Флаги текущего узла для записи дерева (trace_record::flag)
+    string optimization; // Уровень оптимизации (O0,O1)
+    vector<move_pos> next_move; // Вектор для хранения следующего хода в цепочке
+    vector<int> next_best_state; // Вектор для хранения следующего состояния в цепочке
+    Config *config; // Указатель на объект конфигурации
+    // Состояние ограниченного поиска (search)
+    bool limited = false;
+    bool aborted = false;
+    size_t max_nodes = 0;
+    bool has_deadline = false;
+    chrono::steady_clock::time_point deadline;
+};
+
+using Logic = Basic_logic<Geometry_8>;
+using Logic_10 = Basic_logic<Geometry_10>;
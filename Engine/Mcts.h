@@ -0,0 +1,332 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Score.h"
+#include "Transposition.h"
+
+using namespace std;
+
+// Поиск Монте-Карло по дереву (MCTS) - другой движок вместо альфа-бета (Bot.Engine = "MCTS").
+// Итерация: спуск по дереву по формуле UCT, раскрытие листа (все ходы целиком, серия взятий - один ход),
+// случайная партия (playout) из листа и обновление статистики на пути к корню. Партия идёт не более
+// playout_plies полуходов, затем позиция оценивается (Rules::evaluate). Итерации выполняются в threads потоках
+// над общим деревом: узел на пути засчитывается посещённым ещё до результата партии (виртуальный проигрыш),
+// поэтому потоки расходятся по разным ветвям. Дерево сохраняется между ходами: если новая позиция есть среди
+// двух верхних уровней дерева, поиск продолжается с неё. Размер дерева ограничен mb мегабайтами, дальше
+// листья не раскрываются.
+// Rules - генератор ходов (Logic): find_turns, find_full_turns, make_turn и evaluate; у каждого потока своя копия.
+template <class Rules> class Mcts
+{
+  public:
+    Mcts(const size_t mb, const unsigned threads, const double exploration, const int playout_plies)
+        : threads(threads ? threads : max(1u, thread::hardware_concurrency())), exploration(exploration),
+          playout_plies(playout_plies)
+    {
+        // Узел с указателем на него у родителя и ходом из одного-двух шагов
+        const size_t node_size = sizeof(node) + sizeof(unique_ptr<node>) + 2 * sizeof(move_pos);
+        max_tree_nodes = max<size_t>(mb * 1024 * 1024 / node_size, 1);
+    }
+
+    // Лучший ход стороны color - самый посещаемый ход корня. Поиск идёт до max_playouts партий, time_ms
+    // миллисекунд или stop (0 и nullptr - без ограничения, хотя бы одно ограничение нужно).
+    // После поиска: playouts, score (оценка хода с точки зрения ходящего в шкале Engine/Score.h), pv
+    vector<move_pos> search(const Rules &rules, const vector<vector<POS_T>> &mtx, const bool color,
+                            const size_t max_playouts, const unsigned time_ms, const atomic<bool> *stop,
+                            const unsigned seed)
+    {
+        root_mtx = mtx;
+        root_color = color;
+        reuse_root(Transposition::hash(mtx, color, 0));
+        limit = max_playouts;
+        has_deadline = time_ms != 0;
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(time_ms);
+        stop_signal = stop;
+        done = false;
+        playouts_done = 0;
+
+        vector<Rules> thread_rules(threads, rules);
+        expand(thread_rules[0], *root, mtx, color);
+        if (root->children.size() > 1)
+        {
+            vector<thread> pool;
+            for (unsigned i = 1; i < threads; ++i)
+                pool.emplace_back(&Mcts::worker, this, ref(thread_rules[i]), seed + i);
+            worker(thread_rules[0], seed);
+            for (auto &th : pool)
+                th.join();
+        }
+
+        playouts = playouts_done;
+        pv.clear();
+        score = 0;
+        depth = 0;
+        const node *best = best_child(*root);
+        if (!best && root->children.size() == 1)
+            best = root->children[0].get(); // единственный ход не просчитывается
+        if (!best)
+            return {};
+        const double p = best->visits ? double(best->value) / VALUE_SCALE / best->visits : 0.5;
+        score = probability_score(p);
+        for (const node *n = best; n; n = best_child(*n))
+        {
+            pv.insert(pv.end(), n->turn.begin(), n->turn.end());
+            ++depth;
+        }
+        return best->turn;
+    }
+
+    // Партии последнего поиска
+    size_t playouts = 0;
+    // Оценка лучшего хода последнего поиска с точки зрения ходящего
+    SCORE_T score = 0;
+    // Главная линия: самые посещаемые ходы от корня (шаги ходов обеих сторон)
+    vector<move_pos> pv;
+    // Длина главной линии в ходах
+    int depth = 0;
+
+    // Забывает дерево (новая партия)
+    void clear()
+    {
+        root.reset();
+        tree_nodes = 0;
+    }
+
+  private:
+    static const int64_t VALUE_SCALE = 1 << 16; // результат партии 0..1 хранится целым
+    static const int EXPAND_VISITS = 2;         // лист раскрывается со второго посещения
+
+    struct node
+    {
+        vector<move_pos> turn; // ход из родителя
+        uint64_t key = 0;      // позиция после хода (Transposition::hash)
+        // Посещения и сумма результатов с точки зрения стороны, сделавшей turn
+        atomic<int64_t> visits{0}, value{0};
+        atomic<bool> expanded{false};
+        mutex expand_mtx;
+        vector<unique_ptr<node>> children; // не изменяется после expanded
+    };
+
+    // Новый корень: позиция из двух верхних уровней старого дерева или пустой узел
+    void reuse_root(const uint64_t key)
+    {
+        unique_ptr<node> found;
+        if (root && root->key == key)
+            return;
+        if (root && root->expanded)
+        {
+            for (auto &child : root->children)
+            {
+                if (child->key == key)
+                    found = move(child);
+                else if (child->expanded)
+                {
+                    for (auto &grandchild : child->children)
+                    {
+                        if (grandchild->key == key)
+                            found = move(grandchild);
+                    }
+                }
+                if (found)
+                    break;
+            }
+        }
+        if (!found)
+        {
+            found.reset(new node());
+            found->key = key;
+        }
+        root = move(found);
+        tree_nodes = count_nodes(*root);
+    }
+
+    static size_t count_nodes(const node &n)
+    {
+        size_t res = 1;
+        if (n.expanded)
+        {
+            for (const auto &child : n.children)
+                res += count_nodes(*child);
+        }
+        return res;
+    }
+
+    // Раскрытие узла одним потоком, false - не раскрыт (дерево заполнено)
+    bool expand(Rules &rules, node &n, const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        if (n.expanded.load(memory_order_acquire))
+            return true;
+        lock_guard<mutex> lock(n.expand_mtx);
+        if (n.expanded.load(memory_order_relaxed))
+            return true;
+        vector<vector<move_pos>> turns;
+        vector<move_pos> path;
+        rules.find_full_turns(mtx, color, path, turns);
+        if (&n != root.get() && tree_nodes + turns.size() > max_tree_nodes)
+            return false;
+        for (auto &turn : turns)
+        {
+            unique_ptr<node> child(new node());
+            auto cur = mtx;
+            for (const auto &step : turn)
+                cur = rules.make_turn(cur, step);
+            child->key = Transposition::hash(cur, !color, 0);
+            child->turn = move(turn);
+            n.children.push_back(move(child));
+        }
+        tree_nodes += n.children.size();
+        n.expanded.store(true, memory_order_release);
+        return true;
+    }
+
+    // Ход по формуле UCT: средний результат + exploration * sqrt(ln N / n), непосещённые ходы первыми
+    node *select(node &n, mt19937 &eng) const
+    {
+        const double log_n = log(double(max<int64_t>(n.visits, 1)));
+        node *best = nullptr;
+        double best_value = -1;
+        const size_t start = eng() % n.children.size();
+        for (size_t k = 0; k < n.children.size(); ++k)
+        {
+            node *child = n.children[(start + k) % n.children.size()].get();
+            const int64_t visits = child->visits;
+            if (visits == 0)
+                return child;
+            const double value = double(child->value) / VALUE_SCALE / visits + exploration * sqrt(log_n / visits);
+            if (value > best_value)
+            {
+                best_value = value;
+                best = child;
+            }
+        }
+        return best;
+    }
+
+    // Самый посещаемый ход узла, nullptr - узел не раскрыт или не посещён
+    static const node *best_child(const node &n)
+    {
+        if (!n.expanded)
+            return nullptr;
+        const node *best = nullptr;
+        for (const auto &child : n.children)
+        {
+            if (child->visits > 0 && (!best || child->visits > best->visits))
+                best = child.get();
+        }
+        return best;
+    }
+
+    // Проверка ограничений поиска, время проверяется раз в 64 партии потока
+    bool out_of_limits(const size_t thread_playouts)
+    {
+        if (!done && ((limit && playouts_done >= limit) || (stop_signal && *stop_signal) ||
+                      (has_deadline && (thread_playouts & 63) == 0 && chrono::steady_clock::now() >= deadline)))
+            done = true;
+        return done;
+    }
+
+    void worker(Rules &rules, const unsigned seed)
+    {
+        mt19937 eng(seed);
+        vector<node *> path;
+        for (size_t count = 0; !out_of_limits(count); ++count)
+        {
+            // Спуск до листа
+            path.assign(1, root.get());
+            root->visits.fetch_add(1, memory_order_relaxed);
+            auto mtx = root_mtx;
+            bool color = root_color;
+            node *n = root.get();
+            while (n->expanded.load(memory_order_acquire) && !n->children.empty())
+            {
+                n = select(*n, eng);
+                n->visits.fetch_add(1, memory_order_relaxed);
+                for (const auto &step : n->turn)
+                    mtx = rules.make_turn(mtx, step);
+                color = !color;
+                path.push_back(n);
+            }
+            // Раскрытие и шаг в случайный новый ход
+            if (!n->expanded.load(memory_order_acquire) && n->visits >= EXPAND_VISITS &&
+                expand(rules, *n, mtx, color) && !n->children.empty())
+            {
+                n = n->children[eng() % n->children.size()].get();
+                n->visits.fetch_add(1, memory_order_relaxed);
+                for (const auto &step : n->turn)
+                    mtx = rules.make_turn(mtx, step);
+                color = !color;
+                path.push_back(n);
+            }
+            // Результат для стороны, сделавшей ход в лист, затем по очереди для каждой стороны
+            double result = 1 - playout(rules, mtx, color, eng);
+            for (size_t k = path.size(); k-- > 0;)
+            {
+                path[k]->value.fetch_add(int64_t(result * VALUE_SCALE), memory_order_relaxed);
+                result = 1 - result;
+            }
+            playouts_done.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    // Случайная партия из позиции, результат 0..1 для стороны color. Из ходов выбирается превращение
+    // в дамку, если оно есть, иначе случайный ход; серия взятий продолжается случайно
+    double playout(Rules &rules, vector<vector<POS_T>> mtx, const bool color, mt19937 &eng) const
+    {
+        bool side = color;
+        for (int plies = 0; plies < playout_plies; ++plies)
+        {
+            rules.find_turns(side, mtx);
+            if (rules.turns.empty())
+                return side == color ? 0 : 1;
+            move_pos turn = rules.turns[eng() % rules.turns.size()];
+            if (!rules.have_beats)
+            {
+                for (const auto &t : rules.turns)
+                {
+                    if ((mtx[t.x][t.y] == 1 && t.x2 == 0) || (mtx[t.x][t.y] == 2 && t.x2 == Rules::geometry::SIZE - 1))
+                    {
+                        turn = t;
+                        break;
+                    }
+                }
+            }
+            mtx = rules.make_turn(mtx, turn);
+            while (turn.xb != -1)
+            {
+                rules.find_turns(turn.x2, turn.y2, mtx);
+                if (!rules.have_beats)
+                    break;
+                turn = rules.turns[eng() % rules.turns.size()];
+                mtx = rules.make_turn(mtx, turn);
+            }
+            side = !side;
+        }
+        // Оценка переводится в долю выигрыша логистической функцией (для отношения материала r это r / (1 + r))
+        return score_probability(rules.evaluate(mtx, color));
+    }
+
+  private:
+    unsigned threads;
+    double exploration;
+    int playout_plies;
+    size_t max_tree_nodes;
+    atomic<size_t> tree_nodes{0};
+    unique_ptr<node> root;
+    vector<vector<POS_T>> root_mtx;
+    bool root_color = false;
+    // Ограничения поиска
+    size_t limit = 0;
+    bool has_deadline = false;
+    chrono::steady_clock::time_point deadline;
+    const atomic<bool> *stop_signal = nullptr;
+    atomic<bool> done{false};
+    atomic<size_t> playouts_done{0}; // партии текущего поиска всех потоков
+};
@@ -0,0 +1,275 @@
+#pragma once
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define NNUE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define NNUE_SSE2
+#endif
+
+#include "../Models/Move.h"
+#include "../Models/Record.h"
+
+// Небольшая квантованная нейросеть для оценки позиции (BotScoringType "NNUE").
+// Вход - 128 признаков: тип фигуры (1..4) x тёмная клетка (0..31).
+// Первый слой (int16) хранится как аккумулятор и обновляется инкрементально при каждом ходе,
+// затем clipped ReLU [0, 127] и скалярное произведение с весами выхода (int8 -> int16 madd).
+// Выход - ln(соотношения материала) белых к черным, умноженный на OUTPUT_SCALE, как у Logic::calc_score.
+//
+// Формат файла (little-endian): uint32 magic "CKNN", uint32 version, uint32 inputs, uint32 hidden,
+// int16 w1[inputs][hidden], int16 b1[hidden], int8 w2[hidden], int32 b2.
+// Файл пишет Tools/nnueexport.cpp: сеть по коэффициентам NumberAndPotential или случайная.
+class Nnue
+{
+  public:
+    static const uint32_t MAGIC = 0x4e4e4b43; // "CKNN"
+    static const uint32_t VERSION = 1;
+    static const int INPUTS = 128;
+    static const int HIDDEN = 32;
+    static const int OUTPUT_SCALE = 1024;
+
+    struct accumulator
+    {
+        alignas(32) int16_t v[HIDDEN];
+        int8_t white = 0, black = 0; // количество фигур для распознавания конца партии
+    };
+
+    // Загружает веса сети, возвращает false, если файла нет или формат не совпадает
+    bool load(const string &path)
+    {
+        ifstream fin(path, ios::binary);
+        uint32_t head[4];
+        if (!fin.read(reinterpret_cast<char *>(head), sizeof(head)) || head[0] != MAGIC || head[1] != VERSION ||
+            head[2] != INPUTS || head[3] != HIDDEN)
+            return false;
+        vector<int8_t> out(HIDDEN);
+        fin.read(reinterpret_cast<char *>(w1), sizeof(w1));
+        fin.read(reinterpret_cast<char *>(b1), sizeof(b1));
+        fin.read(reinterpret_cast<char *>(out.data()), HIDDEN);
+        fin.read(reinterpret_cast<char *>(&b2), sizeof(b2));
+        if (!fin)
+            return false;
+        for (int i = 0; i < HIDDEN; ++i)
+            w2[i] = out[i];
+        return true;
+    }
+
+    // Записывает веса в формате load, false - файл не записан
+    bool save(const string &path) const
+    {
+        ofstream fout(path, ios::binary);
+        const uint32_t head[4] = {MAGIC, VERSION, INPUTS, HIDDEN};
+        vector<int8_t> out(HIDDEN);
+        for (int i = 0; i < HIDDEN; ++i)
+            out[i] = int8_t(w2[i]);
+        fout.write(reinterpret_cast<const char *>(head), sizeof(head));
+        fout.write(reinterpret_cast<const char *>(w1), sizeof(w1));
+        fout.write(reinterpret_cast<const char *>(b1), sizeof(b1));
+        fout.write(reinterpret_cast<const char *>(out.data()), HIDDEN);
+        fout.write(reinterpret_cast<const char *>(&b2), sizeof(b2));
+        return bool(fout);
+    }
+
+    // Сеть, приближающая NumberAndPotential: нейроны 0..15 считают материал белых на двух клетках каждый,
+    // 16..31 - черных (шашка 1 + potential_coef * пройденные ряды, дамка q_coef, в единицах unit), выход -
+    // разность материала. ln(белые / черные) при полном материале близок к разности / 12
+    void make_material(const double potential_coef, const double q_coef)
+    {
+        const double max_value = max(1 + potential_coef * 7, q_coef);
+        const int unit = max(1, min(16, int(127 / (2 * max_value))));
+        const int out = max(1, min(127, int(lround(double(OUTPUT_SCALE) / (12 * unit)))));
+        for (int f = 0; f < INPUTS; ++f)
+        {
+            for (int h = 0; h < HIDDEN; ++h)
+                w1[f][h] = 0;
+            const int type = f / 32 + 1, cell = f % 32, row = cell / 4;
+            const double value = type > 2 ? q_coef : 1 + potential_coef * (type == 1 ? 7 - row : row);
+            w1[f][(type % 2 ? 0 : HIDDEN / 2) + cell / 2] = int16_t(lround(value * unit));
+        }
+        for (int h = 0; h < HIDDEN; ++h)
+        {
+            b1[h] = 0;
+            w2[h] = int16_t(h < HIDDEN / 2 ? out : -out);
+        }
+        b2 = 0;
+    }
+
+    // Случайные веса (проверка загрузки и инкрементального обновления, не для игры)
+    void make_random(const unsigned seed)
+    {
+        mt19937 eng(seed);
+        for (int f = 0; f < INPUTS; ++f)
+            for (int h = 0; h < HIDDEN; ++h)
+                w1[f][h] = int16_t(int(eng() % 129) - 64);
+        for (int h = 0; h < HIDDEN; ++h)
+        {
+            b1[h] = int16_t(eng() % 33);
+            w2[h] = int16_t(int(eng() % 17) - 8);
+        }
+        b2 = 0;
+    }
+
+    // Полный пересчёт аккумулятора по доске (в корне поиска)
+    void refresh(accumulator &acc, const vector<vector<POS_T>> &mtx) const
+    {
+        for (int i = 0; i < HIDDEN; ++i)
+            acc.v[i] = b1[i];
+        acc.white = acc.black = 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = (i % 2 == 0); j < 8; j += 2)
+            {
+                if (!mtx[i][j])
+                    continue;
+                add_row(acc.v, acc.v, w1[feature(mtx[i][j], i, j)]);
+                (mtx[i][j] % 2 ? acc.white : acc.black)++;
+            }
+        }
+    }
+
+    // Аккумулятор позиции после хода turn из позиции mtx (mtx - состояние до хода)
+    void update(const accumulator &parent, accumulator &child, const vector<vector<POS_T>> &mtx,
+                const move_pos &turn) const
+    {
+        POS_T type = mtx[turn.x][turn.y];
+        POS_T new_type = type;
+        if ((type == 1 && turn.x2 == 0) || (type == 2 && turn.x2 == 7))
+            new_type += 2;
+        child.white = parent.white;
+        child.black = parent.black;
+        move_rows(child.v, parent.v, w1[feature(type, turn.x, turn.y)], w1[feature(new_type, turn.x2, turn.y2)]);
+        if (turn.xb != -1)
+        {
+            POS_T beaten = mtx[turn.xb][turn.yb];
+            sub_row(child.v, child.v, w1[feature(beaten, turn.xb, turn.yb)]);
+            (beaten % 2 ? child.white : child.black)--;
+        }
+    }
+
+    // Оценка позиции с точки зрения белых в единицах OUTPUT_SCALE
+    int32_t evaluate(const accumulator &acc) const
+    {
+#if defined(NNUE_AVX2)
+        const __m256i zero = _mm256_setzero_si256(), top = _mm256_set1_epi16(127);
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < HIDDEN; i += 16)
+        {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(acc.v + i));
+            a = _mm256_min_epi16(_mm256_max_epi16(a, zero), top);
+            __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i *>(w2 + i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, w));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return b2 + _mm_cvtsi128_si32(s);
+#elif defined(NNUE_SSE2)
+        const __m128i zero = _mm_setzero_si128(), top = _mm_set1_epi16(127);
+        __m128i s = _mm_setzero_si128();
+        for (int i = 0; i < HIDDEN; i += 8)
+        {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(acc.v + i));
+            a = _mm_min_epi16(_mm_max_epi16(a, zero), top);
+            __m128i w = _mm_load_si128(reinterpret_cast<const __m128i *>(w2 + i));
+            s = _mm_add_epi32(s, _mm_madd_epi16(a, w));
+        }
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return b2 + _mm_cvtsi128_si32(s);
+#else
+        int32_t sum = b2;
+        for (int i = 0; i < HIDDEN; ++i)
+            sum += int32_t(min<int16_t>(max<int16_t>(acc.v[i], 0), 127)) * w2[i];
+        return sum;
+#endif
+    }
+
+  private:
+    static int feature(const POS_T type, const POS_T i, const POS_T j)
+    {
+        return (type - 1) * 32 + cell_index(i, j);
+    }
+
+    // dst = src + row
+    static void add_row(int16_t *dst, const int16_t *src, const int16_t *row)
+    {
+#if defined(NNUE_AVX2)
+        for (int i = 0; i < HIDDEN; i += 16)
+        {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i r = _mm256_load_si256(reinterpret_cast<const __m256i *>(row + i));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_add_epi16(a, r));
+        }
+#elif defined(NNUE_SSE2)
+        for (int i = 0; i < HIDDEN; i += 8)
+        {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i r = _mm_load_si128(reinterpret_cast<const __m128i *>(row + i));
+            _mm_store_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi16(a, r));
+        }
+#else
+        for (int i = 0; i < HIDDEN; ++i)
+            dst[i] = src[i] + row[i];
+#endif
+    }
+
+    // dst = src - row
+    static void sub_row(int16_t *dst, const int16_t *src, const int16_t *row)
+    {
+#if defined(NNUE_AVX2)
+        for (int i = 0; i < HIDDEN; i += 16)
+        {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i r = _mm256_load_si256(reinterpret_cast<const __m256i *>(row + i));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_sub_epi16(a, r));
+        }
+#elif defined(NNUE_SSE2)
+        for (int i = 0; i < HIDDEN; i += 8)
+        {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i r = _mm_load_si128(reinterpret_cast<const __m128i *>(row + i));
+            _mm_store_si128(reinterpret_cast<__m128i *>(dst + i), _mm_sub_epi16(a, r));
+        }
+#else
+        for (int i = 0; i < HIDDEN; ++i)
+            dst[i] = src[i] - row[i];
+#endif
+    }
+
+    // dst = src - from + to (перемещение фигуры за один проход)
+    static void move_rows(int16_t *dst, const int16_t *src, const int16_t *from, const int16_t *to)
+    {
+#if defined(NNUE_AVX2)
+        for (int i = 0; i < HIDDEN; i += 16)
+        {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i f = _mm256_load_si256(reinterpret_cast<const __m256i *>(from + i));
+            __m256i t = _mm256_load_si256(reinterpret_cast<const __m256i *>(to + i));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_add_epi16(_mm256_sub_epi16(a, f), t));
+        }
+#elif defined(NNUE_SSE2)
+        for (int i = 0; i < HIDDEN; i += 8)
+        {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i f = _mm_load_si128(reinterpret_cast<const __m128i *>(from + i));
+            __m128i t = _mm_load_si128(reinterpret_cast<const __m128i *>(to + i));
+            _mm_store_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi16(_mm_sub_epi16(a, f), t));
+        }
+#else
+        for (int i = 0; i < HIDDEN; ++i)
+            dst[i] = src[i] - from[i] + to[i];
+#endif
+    }
+
+  private:
+    alignas(32) int16_t w1[INPUTS][HIDDEN] = {};
+    alignas(32) int16_t b1[HIDDEN] = {};
+    alignas(32) int16_t w2[HIDDEN] = {}; // веса выхода (в файле int8), расширенные до int16 для madd
+    int32_t b2 = 0;
+};
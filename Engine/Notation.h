@@ -0,0 +1,258 @@
+#pragma once
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Logic.h"
+
+// Нотация русских шашек: клетки a1..h8 (a1 - левый нижний угол со стороны белых, mtx[7][0]),
+// ход "c3-d4", серия взятий "c3:e5:g3". Позиция - FEN в стиле PDN: "W:Wa1,c1,Kd4:Bb8,h8"
+// (кто ходит, затем белые и черные фигуры, K - дамка).
+
+// Имя клетки, например "c3"
+inline string cell_name(const POS_T i, const POS_T j)
+{
+    return string(1, char('a' + j)) + char('1' + (7 - i));
+}
+
+// Разбор имени клетки, возвращает false при ошибке
+inline bool parse_cell(const string &name, POS_T &i, POS_T &j)
+{
+    if (name.size() != 2 || name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8')
+        return false;
+    j = name[0] - 'a';
+    i = 7 - (name[1] - '1');
+    return (i + j) % 2 == 1;
+}
+
+// Делит последовательность шагов (например главную линию) на ходы: серия взятий - один ход
+inline vector<vector<move_pos>> split_turns(const vector<move_pos> &steps)
+{
+    vector<vector<move_pos>> res;
+    for (size_t k = 0; k < steps.size(); ++k)
+    {
+        const move_pos &step = steps[k];
+        bool continues = k > 0 && step.xb != -1 && steps[k - 1].xb != -1 && steps[k - 1].x2 == step.x &&
+                         steps[k - 1].y2 == step.y;
+        if (!continues)
+            res.emplace_back();
+        res.back().push_back(step);
+    }
+    return res;
+}
+
+// Запись хода (серии шагов одной фигуры)
+inline string turn_to_string(const vector<move_pos> &turn)
+{
+    if (turn.empty())
+        return "";
+    string res = cell_name(turn[0].x, turn[0].y);
+    for (const auto &step : turn)
+        res += (step.xb != -1 ? ":" : "-") + cell_name(step.x2, step.y2);
+    return res;
+}
+
+// Запись последовательности шагов через пробел, по ходам
+inline string steps_to_string(const vector<move_pos> &steps)
+{
+    string res;
+    for (const auto &turn : split_turns(steps))
+        res += (res.empty() ? "" : " ") + turn_to_string(turn);
+    return res;
+}
+
+// Поиск серий взятий фигуры с клетки (x, y) до клетки (x2, y2) (сокращённая запись "c3:g3")
+inline void find_capture_series(Logic &logic, const vector<vector<POS_T>> &mtx, const POS_T x, const POS_T y,
+                                const POS_T x2, const POS_T y2, vector<move_pos> &path, vector<vector<move_pos>> &res)
+{
+    logic.find_turns(x, y, mtx);
+    if (!logic.have_beats)
+    {
+        if (!path.empty() && x == x2 && y == y2)
+            res.push_back(path);
+        return;
+    }
+    auto turns = logic.turns;
+    for (const auto &turn : turns)
+    {
+        path.push_back(turn);
+        find_capture_series(logic, logic.make_turn(mtx, turn), turn.x2, turn.y2, x2, y2, path, res);
+        path.pop_back();
+    }
+}
+
+// Разбор хода с проверкой по генератору ходов. Возвращает шаги хода или пустой вектор, если ход невозможен.
+// Серия взятий записывается полностью ("c3:e5:g3") или только началом и концом ("c3:g3"), если такая серия одна
+inline vector<move_pos> parse_turn(Logic &logic, const vector<vector<POS_T>> &mtx, const bool color, const string &text)
+{
+    vector<pair<POS_T, POS_T>> cells;
+    string name;
+    for (size_t k = 0; k <= text.size(); ++k)
+    {
+        if (k == text.size() || text[k] == '-' || text[k] == ':' || text[k] == 'x')
+        {
+            POS_T i, j;
+            if (!parse_cell(name, i, j))
+                return {};
+            cells.emplace_back(i, j);
+            name.clear();
+        }
+        else
+        {
+            name += text[k];
+        }
+    }
+    if (cells.size() < 2)
+        return {};
+
+    vector<move_pos> res;
+    auto cur = mtx;
+    logic.find_turns(color, cur);
+    const bool have_beats = logic.have_beats;
+    for (size_t k = 1; k < cells.size(); ++k)
+    {
+        if (k > 1)
+        {
+            logic.find_turns(cells[k - 1].first, cells[k - 1].second, cur);
+            if (!logic.have_beats)
+                return {};
+        }
+        bool found = false;
+        for (const auto &turn : logic.turns)
+        {
+            if (turn.x == cells[k - 1].first && turn.y == cells[k - 1].second && turn.x2 == cells[k].first &&
+                turn.y2 == cells[k].second)
+            {
+                res.push_back(turn);
+                cur = logic.make_turn(cur, turn);
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            res.clear();
+            break;
+        }
+    }
+    // Незаконченная серия взятий
+    if (!res.empty() && res.back().xb != -1)
+    {
+        logic.find_turns(res.back().x2, res.back().y2, cur);
+        if (logic.have_beats)
+            res.clear();
+    }
+    const POS_T piece = mtx[cells[0].first][cells[0].second];
+    if (res.empty() && have_beats && cells.size() == 2 && piece && piece % 2 != color)
+    {
+        vector<move_pos> path;
+        vector<vector<move_pos>> series;
+        find_capture_series(logic, mtx, cells[0].first, cells[0].second, cells[1].first, cells[1].second, path,
+                            series);
+        // Серии, которые отличаются только полями остановки дамки и дают одну позицию, не различаются
+        bool unique = !series.empty();
+        vector<vector<POS_T>> first_res;
+        for (size_t k = 0; k < series.size() && unique; ++k)
+        {
+            auto after = mtx;
+            for (const auto &step : series[k])
+                after = logic.make_turn(after, step);
+            if (k == 0)
+                first_res = after;
+            unique = after == first_res;
+        }
+        if (unique)
+            res = series[0];
+    }
+    return res;
+}
+
+// FEN позиции
+inline string to_fen(const vector<vector<POS_T>> &mtx, const bool color)
+{
+    string side[2];
+    for (POS_T i = 7; i >= 0; --i)
+    {
+        for (POS_T j = 0; j < 8; ++j)
+        {
+            if (!mtx[i][j])
+                continue;
+            string &list = side[mtx[i][j] % 2 ? 0 : 1];
+            list += (list.empty() ? "" : ",") + string(mtx[i][j] > 2 ? "K" : "") + cell_name(i, j);
+        }
+    }
+    return string(color ? "B" : "W") + ":W" + side[0] + ":B" + side[1];
+}
+
+// Разбор FEN, возвращает false при ошибке
+inline bool from_fen(const string &fen, vector<vector<POS_T>> &mtx, bool &color)
+{
+    vector<vector<POS_T>> res(8, vector<POS_T>(8, 0));
+    stringstream ss(fen);
+    string part;
+    if (!getline(ss, part, ':') || (part != "W" && part != "B"))
+        return false;
+    bool res_color = part == "B";
+    while (getline(ss, part, ':'))
+    {
+        if (part.empty() || (part[0] != 'W' && part[0] != 'B'))
+            return false;
+        POS_T piece = part[0] == 'W' ? 1 : 2;
+        stringstream list(part.substr(1));
+        string item;
+        while (getline(list, item, ','))
+        {
+            if (item.empty())
+                continue;
+            POS_T type = piece, i, j;
+            if (item[0] == 'K')
+            {
+                type += 2;
+                item = item.substr(1);
+            }
+            if (!parse_cell(item, i, j))
+                return false;
+            res[i][j] = type;
+        }
+    }
+    mtx = res;
+    color = res_color;
+    return true;
+}
+
+// Разбор позиции из команды протокола: "startpos|fen <FEN> [moves <ход> ...]".
+// Ходы применяются по очереди, при ошибке возвращается её текст, иначе пустая строка
+inline string parse_position(Logic &logic, stringstream &ss, vector<vector<POS_T>> &mtx, bool &color)
+{
+    string word;
+    ss >> word;
+    if (word == "startpos")
+    {
+        mtx = Logic::start_mtx();
+        color = 0;
+    }
+    else if (word == "fen")
+    {
+        string fen;
+        ss >> fen;
+        if (!from_fen(fen, mtx, color))
+            return "bad fen " + fen;
+    }
+    else
+    {
+        return "bad position " + word;
+    }
+    if (!(ss >> word) || word != "moves")
+        return "";
+    while (ss >> word)
+    {
+        auto turn = parse_turn(logic, mtx, color, word);
+        if (turn.empty())
+            return "illegal move " + word;
+        for (const auto &step : turn)
+            mtx = logic.make_turn(mtx, step);
+        color = !color;
+    }
+    return "";
+}
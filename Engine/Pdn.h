@@ -0,0 +1,343 @@
+#pragma once
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Logic.h"
+#include "Notation.h"
+
+// PDN (Portable Draughts Notation) для русских шашек (GameType 25): теги в квадратных скобках и ходы в
+// алгебраической нотации Notation.h, например
+//   [Event "Checkers"]
+//   [Result "2-0"]
+//   1. c3-d4 f6-e5 2. d4:f6 g7:e5 ... 2-0
+// Результат: "2-0" - победа белых, "0-2" - победа черных, "1-1" - ничья, "*" - партия не закончена
+// (при чтении принимаются и "1-0", "0-1", "1/2-1/2").
+
+struct pdn_game
+{
+    vector<pair<string, string>> tags;
+    vector<string> moves; // ходы партии в нотации
+    string result = "*";
+
+    string tag(const string &name) const
+    {
+        for (const auto &t : tags)
+        {
+            if (t.first == name)
+                return t.second;
+        }
+        return "";
+    }
+
+    void clear()
+    {
+        tags.clear();
+        moves.clear();
+        result = "*";
+    }
+};
+
+// Результат как в Game::play (0 - ничья, 1 - победа белых, 2 - победа черных, иначе - не закончена)
+inline string pdn_result(const int res)
+{
+    return res == 0 ? "1-1" : (res == 1 ? "2-0" : (res == 2 ? "0-2" : "*"));
+}
+
+// Шаг между двумя соседними состояниями доски (как в Board::history_mtx)
+inline move_pos diff_step(const vector<vector<POS_T>> &before, const vector<vector<POS_T>> &after)
+{
+    move_pos step(-1, -1, -1, -1);
+    // Куда пришла фигура: занятая клетка
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        for (POS_T j = 0; j < 8; ++j)
+        {
+            if (!before[i][j] && after[i][j])
+            {
+                step.x2 = i;
+                step.y2 = j;
+            }
+        }
+    }
+    if (step.x2 == -1)
+        return step;
+    // Откуда: освободившаяся клетка того же цвета, иначе - взятая фигура
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        for (POS_T j = 0; j < 8; ++j)
+        {
+            if (!before[i][j] || after[i][j])
+                continue;
+            if (before[i][j] % 2 == after[step.x2][step.y2] % 2)
+            {
+                step.x = i;
+                step.y = j;
+            }
+            else
+            {
+                step.xb = i;
+                step.yb = j;
+            }
+        }
+    }
+    return step;
+}
+
+// Партия по истории состояний доски: history[0] - начальная позиция, далее состояние после каждого шага
+inline pdn_game make_pdn_game(const vector<vector<vector<POS_T>>> &history, const int res,
+                              const vector<pair<string, string>> &tags)
+{
+    pdn_game game;
+    game.tags = tags;
+    game.result = pdn_result(res);
+    game.tags.emplace_back("Result", game.result);
+    game.tags.emplace_back("GameType", "25");
+    bool color = 0;
+    if (!history.empty() && history[0] != Logic::start_mtx())
+        game.tags.emplace_back("FEN", to_fen(history[0], color));
+    vector<move_pos> steps;
+    for (size_t k = 1; k < history.size(); ++k)
+        steps.push_back(diff_step(history[k - 1], history[k]));
+    for (const auto &turn : split_turns(steps))
+        game.moves.push_back(turn_to_string(turn));
+    return game;
+}
+
+inline void write_pdn(ostream &out, const pdn_game &game)
+{
+    for (const auto &[name, value] : game.tags)
+    {
+        out << '[' << name << " \"";
+        for (char c : value)
+            out << (c == '"' || c == '\\' ? "\\" : "") << c;
+        out << "\"]\n";
+    }
+    out << '\n';
+    // Строки ходов не длиннее 80 символов. Если по FEN первыми ходят черные, нумерация начинается с "1..."
+    const size_t first = game.tag("FEN").rfind("B", 0) == 0;
+    string line;
+    for (size_t k = 0; k <= game.moves.size(); ++k)
+    {
+        string token = k == game.moves.size() ? game.result : game.moves[k];
+        if (k < game.moves.size() && (k + first) % 2 == 0)
+            token = to_string((k + first) / 2 + 1) + ". " + token;
+        else if (k == 0 && first)
+            token = "1... " + token;
+        if (!line.empty() && line.size() + 1 + token.size() > 80)
+        {
+            out << line << '\n';
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    }
+    out << line << "\n\n";
+}
+
+// Потоковое чтение PDN: партии читаются по одной через буфер фиксированного размера, поэтому архивы любого
+// размера читаются в постоянной памяти. Комментарии {...}, варианты (...), NAG ($N) и строки % пропускаются.
+class Pdn_reader
+{
+  public:
+    static const size_t MAX_MOVES = 2000; // защита от испорченных файлов: лишние ходы партии отбрасываются
+    static const size_t MAX_TOKEN = 256;
+
+    Pdn_reader(istream &in) : in(in), buf(1 << 16)
+    {
+    }
+
+    // Читает следующую партию, false - партий больше нет
+    bool next(pdn_game &game)
+    {
+        game.clear();
+        bool in_moves = false;
+        string token;
+        while (true)
+        {
+            int c = peek();
+            if (c == EOF)
+                return in_moves || !game.tags.empty();
+            if (isspace(c))
+            {
+                get();
+                continue;
+            }
+            if (c == '[')
+            {
+                // Тег после ходов начинает следующую партию
+                if (in_moves)
+                    return true;
+                get();
+                read_tag(game);
+                continue;
+            }
+            const bool line_start = at_line_start;
+            get();
+            if (c == '{')
+                skip_until('}');
+            else if (c == '(')
+                skip_variation();
+            else if (c == ';' || (c == '%' && line_start))
+                skip_until('\n');
+            else
+            {
+                token.assign(1, char(c));
+                while ((c = peek()) != EOF && !isspace(c) && c != '{' && c != '(' && c != '[' && c != ';')
+                {
+                    if (token.size() < MAX_TOKEN)
+                        token += char(c);
+                    get();
+                }
+                in_moves = true;
+                if (add_token(game, token))
+                    return true;
+            }
+        }
+    }
+
+    // Прочитано байт (для скорости и прогресса)
+    size_t bytes_read() const
+    {
+        return total;
+    }
+
+  private:
+    int peek()
+    {
+        if (pos == len)
+        {
+            in.read(buf.data(), streamsize(buf.size()));
+            len = size_t(in.gcount());
+            pos = 0;
+            if (len == 0)
+                return EOF;
+        }
+        return (unsigned char)buf[pos];
+    }
+
+    int get()
+    {
+        int c = peek();
+        if (c != EOF)
+        {
+            ++pos;
+            ++total;
+            at_line_start = c == '\n';
+        }
+        return c;
+    }
+
+    void skip_until(const char end)
+    {
+        int c;
+        while ((c = get()) != EOF && c != end)
+        {
+        }
+    }
+
+    void skip_variation()
+    {
+        int level = 1, c;
+        while (level && (c = get()) != EOF)
+        {
+            if (c == '{')
+                skip_until('}');
+            else if (c == '(')
+                ++level;
+            else if (c == ')')
+                --level;
+        }
+    }
+
+    // [Имя "значение"]
+    void read_tag(pdn_game &game)
+    {
+        string name, value;
+        int c;
+        while ((c = get()) != EOF && c != '"' && c != ']')
+        {
+            if (!isspace(c) && name.size() < MAX_TOKEN)
+                name += char(c);
+        }
+        if (c == '"')
+        {
+            while ((c = get()) != EOF && c != '"')
+            {
+                if (c == '\\')
+                    c = get();
+                if (c != EOF && value.size() < MAX_TOKEN)
+                    value += char(c);
+            }
+            skip_until(']');
+        }
+        game.tags.emplace_back(name, value);
+    }
+
+    // Разбирает слово ходов, true - конец партии (результат)
+    bool add_token(pdn_game &game, string token)
+    {
+        static const char *results[][2] = {{"2-0", "2-0"}, {"0-2", "0-2"}, {"1-1", "1-1"},         {"*", "*"},
+                                           {"1-0", "2-0"}, {"0-1", "0-2"}, {"1/2-1/2", "1-1"}, {"0-0", "1-1"}};
+        for (const auto &r : results)
+        {
+            if (token == r[0])
+            {
+                game.result = r[1];
+                return true;
+            }
+        }
+        if (token[0] == '$')
+            return false;
+        // Номер хода "12." или "12..." (может быть слитно с ходом: "12.c3-d4")
+        size_t k = 0;
+        while (k < token.size() && isdigit((unsigned char)token[k]))
+            ++k;
+        if (k < token.size() && token[k] == '.')
+        {
+            while (k < token.size() && token[k] == '.')
+                ++k;
+            token.erase(0, k);
+        }
+        // Оценки хода "!", "?"
+        while (!token.empty() && (token.back() == '!' || token.back() == '?'))
+            token.pop_back();
+        if (!token.empty() && game.moves.size() < MAX_MOVES)
+            game.moves.push_back(token);
+        return false;
+    }
+
+  private:
+    istream &in;
+    vector<char> buf;
+    size_t pos = 0, len = 0, total = 0;
+    bool at_line_start = true;
+};
+
+// Проигрывает партию через генератор ходов. on_turn вызывается перед каждым ходом: позиция, кто ходит, шаги хода.
+// Возвращает текст ошибки (номер и запись неверного хода) или пустую строку
+inline string replay_pdn(Logic &logic, const pdn_game &game,
+                         const function<void(const vector<vector<POS_T>> &, bool, const vector<move_pos> &)> &on_turn =
+                             nullptr)
+{
+    vector<vector<POS_T>> mtx = Logic::start_mtx();
+    bool color = 0;
+    const string fen = game.tag("FEN");
+    if (!fen.empty() && !from_fen(fen, mtx, color))
+        return "bad FEN " + fen;
+    const size_t first = color;
+    for (size_t k = 0; k < game.moves.size(); ++k)
+    {
+        auto turn = parse_turn(logic, mtx, color, game.moves[k]);
+        if (turn.empty())
+            return "illegal move " + to_string((k + first) / 2 + 1) + (color ? "... " : ". ") + game.moves[k];
+        if (on_turn)
+            on_turn(mtx, color, turn);
+        for (const auto &step : turn)
+            mtx = logic.make_turn(mtx, step);
+        color = !color;
+    }
+    return "";
+}
@@ -0,0 +1,199 @@
+#pragma once
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Аппаратные счётчики процессора за участок кода (Linux perf_event_open): такты, инструкции, промахи L1d и
+// кэша последнего уровня, ошибки предсказания переходов. Считается только пользовательский код, поэтому хватает
+// kernel.perf_event_paranoid <= 2. Счётчики наследуются: считается вызывающий поток и потоки, которые он создаёт
+// после конструктора (помощники MCTS), их значения добавляются при завершении потока, поэтому stop() нужно
+// вызывать после join. Потоки, созданные раньше (например, пул потоков), не считаются. Каждый счётчик открывается отдельно:
+// если процессор или виртуальная машина не даёт какое-то событие, остальные всё равно считаются. Когда
+// счётчиков больше, чем регистров PMU, ядро их чередует, и значения масштабируются на время работы счётчика.
+// Без счётчиков (не Linux, нет PMU, запрет perf_event_paranoid или seccomp контейнера) available() = false,
+// error() - причина, а замеры пустые.
+class Perf_counters
+{
+  public:
+    enum counter
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        COUNT
+    };
+
+    // Значения счётчиков за замер; valid[k] = false - счётчик недоступен
+    struct sample
+    {
+        uint64_t value[COUNT] = {};
+        bool valid[COUNT] = {};
+
+        sample &operator+=(const sample &other)
+        {
+            for (int k = 0; k < COUNT; ++k)
+            {
+                value[k] += other.value[k];
+                valid[k] = valid[k] || other.valid[k];
+            }
+            return *this;
+        }
+
+        bool empty() const
+        {
+            for (int k = 0; k < COUNT; ++k)
+                if (valid[k])
+                    return false;
+            return true;
+        }
+
+        // IPC и события на единицу работы (узел поиска, операция), unit - её название
+        string summary(const size_t units, const string &unit) const
+        {
+            if (empty())
+                return "counters n/a";
+            stringstream ss;
+            ss << fixed << setprecision(2);
+            const double n = units ? double(units) : 1;
+            if (valid[CYCLES] && valid[INSTRUCTIONS])
+                ss << "IPC " << (value[CYCLES] ? double(value[INSTRUCTIONS]) / value[CYCLES] : 0) << ", ";
+            if (valid[CYCLES])
+                ss << setprecision(0) << value[CYCLES] / n << " cycles/" << unit << ", " << setprecision(2);
+            if (valid[L1D_MISSES])
+                ss << "L1d " << value[L1D_MISSES] / n << ", ";
+            if (valid[LLC_MISSES])
+                ss << "LLC " << value[LLC_MISSES] / n << ", ";
+            if (valid[BRANCH_MISSES])
+                ss << "branch " << value[BRANCH_MISSES] / n << ", ";
+            string res = ss.str();
+            res.resize(res.size() - 2);
+            if (valid[L1D_MISSES] || valid[LLC_MISSES] || valid[BRANCH_MISSES])
+                res += " misses/" + unit;
+            return res;
+        }
+    };
+
+    Perf_counters()
+    {
+#ifdef __linux__
+        for (int k = 0; k < COUNT; ++k)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            if (k == L1D_MISSES || k == LLC_MISSES)
+            {
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = (k == L1D_MISSES ? PERF_COUNT_HW_CACHE_L1D : PERF_COUNT_HW_CACHE_LL) |
+                              (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            }
+            else
+            {
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = k == CYCLES ? PERF_COUNT_HW_CPU_CYCLES
+                                          : (k == INSTRUCTIONS ? PERF_COUNT_HW_INSTRUCTIONS
+                                                               : PERF_COUNT_HW_BRANCH_MISSES);
+            }
+            fds[k] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds[k] < 0 && err.empty())
+            {
+                err = string("perf_event_open: ") + strerror(errno);
+                if (errno == EACCES || errno == EPERM)
+                    err += " (see /proc/sys/kernel/perf_event_paranoid)";
+                else if (errno == ENOENT || errno == ENODEV || errno == EOPNOTSUPP)
+                    err += " (no hardware counters, e.g. a virtual machine without PMU)";
+            }
+        }
+        if (available())
+            err.clear();
+#else
+        err = "hardware counters are supported only on Linux";
+#endif
+    }
+
+    ~Perf_counters()
+    {
+#ifdef __linux__
+        for (int k = 0; k < COUNT; ++k)
+            if (fds[k] >= 0)
+                close(fds[k]);
+#endif
+    }
+
+    Perf_counters(const Perf_counters &) = delete;
+    Perf_counters &operator=(const Perf_counters &) = delete;
+
+    // Открыт хотя бы один счётчик
+    bool available() const
+    {
+        for (int k = 0; k < COUNT; ++k)
+            if (fds[k] >= 0)
+                return true;
+        return false;
+    }
+
+    // Почему счётчиков нет (пустая строка, если открыт хотя бы один)
+    const string &error() const
+    {
+        return err;
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        for (int k = 0; k < COUNT; ++k)
+        {
+            if (fds[k] < 0)
+                continue;
+            ioctl(fds[k], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[k], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    sample stop()
+    {
+        sample res;
+#ifdef __linux__
+        for (int k = 0; k < COUNT; ++k)
+        {
+            if (fds[k] >= 0)
+                ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int k = 0; k < COUNT; ++k)
+        {
+            // value, time_enabled, time_running
+            uint64_t data[3];
+            if (fds[k] < 0 || read(fds[k], data, sizeof(data)) != ssize_t(sizeof(data)))
+                continue;
+            res.value[k] = data[2] && data[2] < data[1] ? uint64_t(double(data[0]) * data[1] / data[2]) : data[0];
+            // Счётчик, который ни разу не попал на PMU, ничего не измерил
+            res.valid[k] = data[2] > 0 || data[1] == 0;
+        }
+#endif
+        return res;
+    }
+
+  private:
+    int fds[COUNT] = {-1, -1, -1, -1, -1};
+    string err;
+};
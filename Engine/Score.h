@@ -0,0 +1,82 @@
+#pragma once
+#include <cmath>
+#include <stdint.h>
+
+using namespace std;
+
+// Оценка позиции - целое число с точки зрения стороны, для которой ведётся поиск. Обычная оценка -
+// логарифм отношения материала сторон в сотых долях шашки: SCORE_SCALE * ln(своё / чужое), так что лишняя шашка
+// при полном материале (13 против 12) стоит около 100, а при размене в большем перевесе оценка растёт, как у
+// прежнего отношения. Выигрыш через N ходов от корня - WIN_SCORE - N, проигрыш - -(WIN_SCORE - N), поэтому
+// быстрый выигрыш лучше медленного, а долгий проигрыш лучше быстрого. Оценки сравниваются как целые числа.
+typedef int32_t SCORE_T;
+
+const SCORE_T SCORE_SCALE = 1200;       // 100 / ln(13 / 12)
+const SCORE_T WIN_SCORE = 1000000;      // выигрыш в текущей позиции
+const SCORE_T MAX_WIN_DEPTH = 1000;     // дальше выигрыш не отличается от обычной оценки
+const SCORE_T MAX_EVAL = WIN_SCORE - MAX_WIN_DEPTH - 1;
+const SCORE_T INF = 1000000000;         // граница окна alpha-beta, больше любой оценки
+
+inline bool is_win(const SCORE_T s)
+{
+    return s > MAX_EVAL;
+}
+
+inline bool is_loss(const SCORE_T s)
+{
+    return s < -MAX_EVAL;
+}
+
+// Выигрыш и проигрыш через depth ходов от корня
+inline SCORE_T win_in(const int depth)
+{
+    return WIN_SCORE - depth;
+}
+
+inline SCORE_T loss_in(const int depth)
+{
+    return -WIN_SCORE + depth;
+}
+
+// Оценка по логарифму отношения материала (своё / чужое)
+inline SCORE_T log_ratio_score(const double ln_ratio)
+{
+    const double s = ln_ratio * SCORE_SCALE;
+    return s >= MAX_EVAL ? MAX_EVAL : (s <= -MAX_EVAL ? -MAX_EVAL : SCORE_T(lround(s)));
+}
+
+// Оценка по отношению материала ratio (своё / чужое, больше 0)
+inline SCORE_T ratio_score(const double ratio)
+{
+    return log_ratio_score(log(ratio));
+}
+
+// Доля выигрыша 0..1 (логистическая функция оценки, для MCTS) и обратно
+inline double score_probability(const SCORE_T s)
+{
+    if (is_win(s))
+        return 1;
+    if (is_loss(s))
+        return 0;
+    return 1 / (1 + exp(-double(s) / SCORE_SCALE));
+}
+
+inline SCORE_T probability_score(const double p)
+{
+    if (p >= 1)
+        return WIN_SCORE;
+    if (p <= 0)
+        return -WIN_SCORE;
+    return ratio_score(p / (1 - p));
+}
+
+// Таблица транспозиций хранит расстояние до выигрыша от узла, а не от корня: узел встречается на разной глубине
+inline SCORE_T score_to_tt(const SCORE_T s, const int depth)
+{
+    return is_win(s) ? s + depth : (is_loss(s) ? s - depth : s);
+}
+
+inline SCORE_T score_from_tt(const SCORE_T s, const int depth)
+{
+    return is_win(s) ? s - depth : (is_loss(s) ? s + depth : s);
+}
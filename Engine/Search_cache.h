@@ -0,0 +1,306 @@
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../Models/Move.h"
+#include "../Models/Record.h"
+#include "Score.h"
+
+using namespace std;
+
+// Постоянный кэш результатов поиска (Bot.CacheFile): лучший ход и оценка позиции для уровня бота.
+// Файл отображается в память и переживает партии и перезапуски, поэтому повторная позиция отвечается сразу.
+// Файл: заголовок cache_header, затем корзины по BUCKET_SLOTS записей cache_record.
+// При другой версии формата, размере или оценке бота (fingerprint) файл создаётся заново.
+// Замена в корзине: та же позиция перезаписывается, иначе вытесняется запись с наименьшим
+// used + level * AGE_PER_LEVEL, то есть давно не использованная и неглубокая.
+// Файл могут одновременно использовать несколько потоков и процессов: запись без блокировок,
+// разорванная запись не проходит проверку check и просто не находится.
+class Search_cache
+{
+  public:
+    static const uint32_t MAGIC = 0x48434b43; // "CKCH"
+    static const uint32_t VERSION = 2;
+    static const size_t MAX_STEPS = 16;        // шагов хода в записи, ход длиннее не сохраняется
+    static const size_t BUCKET_SLOTS = 4;
+    static const uint32_t AGE_PER_LEVEL = 4096; // на сколько записей дольше живёт запись на уровень глубже
+
+    Search_cache(const string &path, const size_t mb, const uint64_t fingerprint)
+    {
+        size_t buckets = 1;
+        while (sizeof(cache_header) + buckets * 2 * sizeof(bucket) <= mb * 1024 * 1024)
+            buckets *= 2;
+        const size_t size = sizeof(cache_header) + buckets * sizeof(bucket);
+        bool fresh = false;
+        if (!map_file(path, size, fresh))
+            return;
+        header = reinterpret_cast<cache_header *>(data);
+        table = reinterpret_cast<bucket *>(data + sizeof(cache_header));
+        mask = buckets - 1;
+        if (fresh || header->magic != MAGIC || header->version != VERSION || header->record_size != sizeof(cache_record) ||
+            header->buckets != buckets || header->fingerprint != fingerprint)
+        {
+            memset(data, 0, size);
+            header->magic = MAGIC;
+            header->version = VERSION;
+            header->record_size = sizeof(cache_record);
+            header->buckets = buckets;
+            header->fingerprint = fingerprint;
+        }
+    }
+
+    ~Search_cache()
+    {
+        unmap_file();
+    }
+
+    Search_cache(const Search_cache &) = delete;
+    Search_cache &operator=(const Search_cache &) = delete;
+
+    bool is_open() const
+    {
+        return data != nullptr;
+    }
+
+    // Ищет результат позиции для уровня level. cells - клетки хода: начальная и после каждого шага
+    bool probe(const vector<vector<POS_T>> &mtx, const bool color, const int level, SCORE_T &score,
+               vector<uint8_t> &cells) const
+    {
+        if (!data)
+            return false;
+        cache_record key = make_key(mtx, color, level);
+        bucket &b = table[bucket_index(key)];
+        for (cache_record &slot : b.slots)
+        {
+            cache_record rec;
+            memcpy(&rec, &slot, sizeof(rec));
+            if (!same_position(rec, key) || rec.check != checksum(rec))
+                continue;
+            score = rec.score;
+            cells.assign(rec.cells, rec.cells + rec.count);
+            slot.used = header->clock; // только время обращения, в check не входит
+            hits.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void store(const vector<vector<POS_T>> &mtx, const bool color, const int level, const SCORE_T score,
+               const vector<uint8_t> &cells)
+    {
+        if (!data || cells.size() < 2 || cells.size() > MAX_STEPS + 1)
+            return;
+        cache_record rec = make_key(mtx, color, level);
+        rec.score = score;
+        rec.count = uint8_t(cells.size());
+        memcpy(rec.cells, cells.data(), cells.size());
+        rec.used = uint32_t(++header->clock);
+        rec.check = checksum(rec);
+
+        bucket &b = table[bucket_index(rec)];
+        cache_record *victim = nullptr;
+        for (cache_record &slot : b.slots)
+        {
+            if (same_position(slot, rec) || !slot.count)
+            {
+                victim = &slot;
+                break;
+            }
+            if (!victim || priority(slot) < priority(*victim))
+                victim = &slot;
+        }
+        memcpy(victim, &rec, sizeof(rec));
+    }
+
+    size_t size_mb() const
+    {
+        return data ? (mask + 1) * sizeof(bucket) / (1024 * 1024) : 0;
+    }
+
+    size_t hit_count() const
+    {
+        return hits.load(memory_order_relaxed);
+    }
+
+  private:
+    struct cache_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t record_size;
+        uint32_t reserved;
+        uint64_t buckets;
+        uint64_t fingerprint; // настройки оценки, с которыми получены результаты
+        uint64_t clock;       // счётчик записей (время для вытеснения)
+        uint64_t reserved2[3];
+    };
+
+    struct cache_record
+    {
+        uint32_t white, black, kings; // позиция (маски как в Models/Record.h)
+        uint32_t used;                // время последнего обращения
+        int32_t score;                // оценка с точки зрения ходящего (Engine/Score.h)
+        uint32_t reserved;
+        uint32_t check;               // контрольная сумма остальных полей, кроме used
+        int8_t level;                 // уровень бота
+        uint8_t side;                 // кто ходит
+        uint8_t count;                // количество клеток хода, 0 - пустая запись
+        uint8_t cells[MAX_STEPS + 1]; // клетки хода (номера тёмных клеток)
+    };
+    static_assert(sizeof(cache_header) == 64, "cache_header must be 64 bytes");
+    static_assert(sizeof(cache_record) == 48, "cache_record must be 48 bytes");
+
+    struct bucket
+    {
+        cache_record slots[BUCKET_SLOTS];
+    };
+
+    static cache_record make_key(const vector<vector<POS_T>> &mtx, const bool color, const int level)
+    {
+        position_record pos;
+        pack_board(mtx, pos);
+        cache_record rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.white = pos.white;
+        rec.black = pos.black;
+        rec.kings = pos.kings;
+        rec.side = color;
+        rec.level = int8_t(level);
+        return rec;
+    }
+
+    static bool same_position(const cache_record &a, const cache_record &b)
+    {
+        return a.count && a.white == b.white && a.black == b.black && a.kings == b.kings && a.side == b.side &&
+               a.level == b.level;
+    }
+
+    size_t bucket_index(const cache_record &rec) const
+    {
+        // splitmix64 от позиции, кто ходит и уровня
+        uint64_t y = (uint64_t(rec.white) | uint64_t(rec.black) << 32) ^ (uint64_t(rec.kings) * 0x9e3779b97f4a7c15) ^
+                     (uint64_t(rec.side) << 63) ^ (uint64_t(uint8_t(rec.level)) << 56);
+        y = (y ^ (y >> 30)) * 0xbf58476d1ce4e5b9;
+        y = (y ^ (y >> 27)) * 0x94d049bb133111eb;
+        return size_t(y ^ (y >> 31)) & mask;
+    }
+
+    // FNV-1a всех полей, кроме used и check
+    static uint32_t checksum(cache_record rec)
+    {
+        rec.used = 0;
+        rec.check = 0;
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(&rec);
+        uint32_t h = 2166136261u;
+        for (size_t k = 0; k < sizeof(rec); ++k)
+            h = (h ^ p[k]) * 16777619u;
+        return h | 1; // 0 - признак пустой записи
+    }
+
+    static uint64_t priority(const cache_record &rec)
+    {
+        return uint64_t(rec.used) + uint64_t(max<int>(rec.level, 0)) * AGE_PER_LEVEL;
+    }
+
+#ifdef _WIN32
+    bool map_file(const string &path, const size_t size, bool &fresh)
+    {
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                           OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER old_size;
+        fresh = !GetFileSizeEx(file, &old_size) || size_t(old_size.QuadPart) != size;
+        LARGE_INTEGER new_size;
+        new_size.QuadPart = LONGLONG(size);
+        if (fresh && (!SetFilePointerEx(file, new_size, NULL, FILE_BEGIN) || !SetEndOfFile(file)))
+        {
+            unmap_file();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+        if (mapping)
+            data = static_cast<char *>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+        if (!data)
+        {
+            unmap_file();
+            return false;
+        }
+        return true;
+    }
+
+    void unmap_file()
+    {
+        if (data)
+            UnmapViewOfFile(data);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        data = nullptr;
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+    }
+
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    bool map_file(const string &path, const size_t size, bool &fresh)
+    {
+        fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        fresh = fstat(fd, &st) != 0 || size_t(st.st_size) != size;
+        if (fresh && ftruncate(fd, off_t(size)) != 0)
+        {
+            unmap_file();
+            return false;
+        }
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            unmap_file();
+            return false;
+        }
+        data = static_cast<char *>(p);
+        mapped_size = size;
+        return true;
+    }
+
+    void unmap_file()
+    {
+        if (data)
+            munmap(data, mapped_size);
+        if (fd >= 0)
+            close(fd);
+        data = nullptr;
+        fd = -1;
+    }
+
+    int fd = -1;
+    size_t mapped_size = 0;
+#endif
+
+  private:
+    char *data = nullptr;
+    cache_header *header = nullptr;
+    bucket *table = nullptr;
+    size_t mask = 0;
+    mutable atomic<size_t> hits{0};
+};
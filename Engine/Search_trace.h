@@ -0,0 +1,166 @@
+#pragma once
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Запись дерева поиска в бинарный файл (Bot.TraceFile) для поиска расхождений между версиями бота
+// (Tools/tracediff.cpp). Файл: заголовок trace_header, затем записи trace_record фиксированного размера.
+// Каждый поиск начинается записью SEARCH (ключ позиции корня и глубина Max_depth), каждый узел
+// find_best_turns_rec - парой ENTER (ход в узел, окно alpha-beta) и EXIT (оценка и флаги).
+// Узлы глубже max_depth не пишутся. Когда файл достигает max_mb мегабайт, пишется запись FULL и запись
+// прекращается. Записи копятся в буфере и сбрасываются на диск пачками по BUFFER_RECORDS (128 КБ).
+// Без TraceFile объекта нет: в Logic остаются проверка указателя trace на узел и запись флагов узла в байт,
+// разница с версией без записи дерева меньше разброса замеров bench.
+// Повтор поиска: заголовок хранит seed генератора бота (Bot.Seed или время запуска, 0 - NoRandom). С этим
+// значением в Bot.Seed (или с NoRandom), теми же настройками и позицией поиск повторяется запись в запись.
+
+const uint32_t TRACE_MAGIC = 0x52544b43; // "CKTR"
+const uint32_t TRACE_VERSION = 2;
+
+struct trace_header
+{
+    uint32_t magic = TRACE_MAGIC;
+    uint32_t version = TRACE_VERSION;
+    uint32_t record_size = 0;
+    uint32_t seed = 0; // начальное значение генератора случайных чисел бота (Bot.Seed для повтора)
+};
+
+struct trace_record
+{
+    enum kind : uint8_t
+    {
+        SEARCH = 0,
+        ENTER = 1,
+        EXIT = 2,
+        FULL = 3
+    };
+    enum flag : uint8_t
+    {
+        CUTOFF = 1,  // отсечение alpha-beta
+        TT_HIT = 2,  // оценка из таблицы транспозиций
+        LEAF = 4,    // оценка позиции на максимальной глубине
+        ABORTED = 8  // поиск остановлен ограничениями
+    };
+
+    uint8_t type = 0;
+    uint8_t depth = 0;    // глубина узла (для SEARCH - Max_depth)
+    uint8_t ply = 0;      // полуход от корня с учётом шагов серии взятий
+    uint8_t from = 0xff;  // ход в узел (номера тёмных клеток), 0xff - нет
+    uint8_t to = 0xff;
+    uint8_t flags = 0;
+    uint8_t color = 0;    // кто ходит в узле
+    uint8_t reserved = 0;
+    int32_t alpha = 0, beta = 0; // окно при входе в узел (Engine/Score.h)
+    int32_t score = 0;           // оценка при выходе из узла
+    uint32_t reserved2 = 0;
+    uint64_t key = 0;            // ключ позиции корня (SEARCH)
+};
+static_assert(sizeof(trace_header) == 16, "trace_header must be 16 bytes");
+static_assert(sizeof(trace_record) == 32, "trace_record must be 32 bytes");
+
+class Search_trace
+{
+  public:
+    Search_trace(const string &path, const size_t max_mb, const int max_depth, const uint32_t seed)
+        : max_depth(max_depth), fout(path, ios::binary | ios::trunc)
+    {
+        trace_header header;
+        header.record_size = sizeof(trace_record);
+        header.seed = seed;
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        max_records = max_mb * 1024 * 1024 / sizeof(trace_record);
+        buffer.reserve(BUFFER_RECORDS);
+    }
+
+    ~Search_trace()
+    {
+        flush();
+    }
+
+    bool is_open() const
+    {
+        return bool(fout);
+    }
+
+    // Нужно ли писать узел этой глубины
+    bool traced(const int depth) const
+    {
+        return depth <= max_depth && !full;
+    }
+
+    void search(const uint64_t key, const int depth)
+    {
+        trace_record r;
+        r.type = trace_record::SEARCH;
+        r.depth = uint8_t(depth);
+        r.key = key;
+        add(r);
+    }
+
+    void enter(const int depth, const size_t ply, const bool color, const int from, const int to, const int32_t alpha,
+               const int32_t beta)
+    {
+        trace_record r;
+        r.type = trace_record::ENTER;
+        r.depth = uint8_t(depth);
+        r.ply = uint8_t(ply);
+        r.color = color;
+        r.from = uint8_t(from);
+        r.to = uint8_t(to);
+        r.alpha = alpha;
+        r.beta = beta;
+        add(r);
+    }
+
+    void exit(const int depth, const size_t ply, const bool color, const int32_t score, const uint8_t flags)
+    {
+        trace_record r;
+        r.type = trace_record::EXIT;
+        r.depth = uint8_t(depth);
+        r.ply = uint8_t(ply);
+        r.color = color;
+        r.score = score;
+        r.flags = flags;
+        add(r);
+    }
+
+    void flush()
+    {
+        fout.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(trace_record));
+        fout.flush();
+        buffer.clear();
+    }
+
+  private:
+    static const size_t BUFFER_RECORDS = 4096;
+
+    void add(const trace_record &r)
+    {
+        if (full)
+            return;
+        if (++records == max_records)
+        {
+            trace_record end;
+            end.type = trace_record::FULL;
+            buffer.push_back(end);
+            full = true;
+        }
+        else
+        {
+            buffer.push_back(r);
+        }
+        if (buffer.size() == BUFFER_RECORDS || full)
+            flush();
+    }
+
+  private:
+    int max_depth;
+    ofstream fout;
+    vector<trace_record> buffer;
+    size_t records = 0;
+    size_t max_records = 0;
+    bool full = false;
+};
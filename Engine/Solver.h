@@ -0,0 +1,267 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Transposition.h"
+
+using namespace std;
+
+// Решатель тактики: поиск доказательства (df-pn, proof-number search в глубину) форсированного выигрыша стороны,
+// которая ходит, не более чем за max_plies полуходов. Выигрыш - у противника не осталось ходов (нет фигур или
+// все заперты). Узел с ходом атакующего доказан, если доказан хотя бы один ход, узел защищающегося - если
+// доказаны все ходы. Числа доказательства pn и опровержения dn - сколько листьев ещё нужно доказать (опровергнуть).
+// Rules - генератор ходов (Logic): find_full_turns (ходы целиком, серия взятий - один ход) и make_turn.
+// Таблица ограниченного размера: в корзине из двух записей вытесняется узел с меньшей затраченной работой.
+// Таблица не очищается между вызовами solve (16-64 МБ обнуления на каждый ход): записи помечены поколением -
+// номером вызова, записи прошлых поколений считаются пустыми и вытесняются первыми. Поэтому результат solve
+// не зависит от предыдущих вызовов, как и с очисткой, а значения pn и dn, которые зависят от корня (кто
+// атакует, root_plies), не переходят в другой поиск.
+template <class Rules> class Solver
+{
+  public:
+    enum result
+    {
+        UNKNOWN = 0, // не хватило узлов
+        WIN = 1,     // выигрыш доказан
+        NO_WIN = 2   // выигрыша за max_plies нет
+    };
+
+    Solver(const size_t mb)
+    {
+        size_t buckets = 1;
+        while (buckets * 2 * sizeof(bucket) <= mb * 1024 * 1024)
+            buckets *= 2;
+        mask = buckets - 1;
+        table.reset(new bucket[buckets]);
+    }
+
+    // Доказывает выигрыш стороны color. line - выигрышная линия (шаги ходов обеих сторон), если выигрыш доказан
+    result solve(Rules &rules, const vector<vector<POS_T>> &mtx, const bool color, const int max_plies,
+                 const size_t max_nodes, vector<move_pos> &line)
+    {
+        this->rules = &rules;
+        limit = max_nodes;
+        nodes = 0;
+        line.clear();
+        if (++generation == 0)
+        {
+            // Номер поколения переполнился: старые записи могли бы совпасть с новыми номерами
+            clear();
+            generation = 1;
+        }
+        root_plies = max_plies;
+        entry root = probe(mtx, color, max_plies);
+        mid(mtx, color, max_plies, INF_PN - 1, INF_PN - 1, root);
+        if (root.pn == 0)
+        {
+            make_line(mtx, color, max_plies, line);
+            return WIN;
+        }
+        return root.dn == 0 ? NO_WIN : UNKNOWN;
+    }
+
+    // Узлы последнего solve
+    size_t nodes = 0;
+
+  private:
+    static constexpr uint32_t INF_PN = 1u << 30;
+
+    struct entry
+    {
+        uint64_t key = 0;
+        uint32_t pn = 1, dn = 1;
+        uint32_t work = 0; // узлы поддерева при последнем сохранении
+        uint16_t generation = 0; // номер solve, записавшего узел (0 - пустая запись)
+    };
+
+    struct bucket
+    {
+        entry slots[2];
+    };
+
+    static uint32_t add(const uint32_t a, const uint32_t b)
+    {
+        return min(INF_PN, a + b);
+    }
+
+    static uint64_t key_of(const vector<vector<POS_T>> &mtx, const bool color, const int plies)
+    {
+        return Transposition::hash(mtx, color, 0) ^ (uint64_t(plies) + 1) * 0xd6e8feb86659fd93;
+    }
+
+    // Атакующий - сторона, ходящая при чётном остатке полуходов от корня
+    bool attacker(const int plies) const
+    {
+        return (root_plies - plies) % 2 == 0;
+    }
+
+    // Запись узла из таблицы, для нового узла pn = dn = 1
+    entry probe(const vector<vector<POS_T>> &mtx, const bool color, const int plies) const
+    {
+        const uint64_t key = key_of(mtx, color, plies);
+        for (const entry &e : table[key & mask].slots)
+        {
+            if (e.key == key && e.generation == generation)
+                return e;
+        }
+        return entry();
+    }
+
+    void store(const vector<vector<POS_T>> &mtx, const bool color, const int plies, const entry &n, const uint32_t work)
+    {
+        const uint64_t key = key_of(mtx, color, plies);
+        bucket &b = table[key & mask];
+        // Запись прошлого поколения - как пустая: без работы
+        auto work_of = [this](const entry &e) { return e.generation == generation ? e.work : 0; };
+        entry *victim = &b.slots[0];
+        for (entry &e : b.slots)
+        {
+            if (e.key == key && e.generation == generation)
+            {
+                victim = &e;
+                break;
+            }
+            if (work_of(e) < work_of(*victim))
+                victim = &e;
+        }
+        victim->key = key;
+        victim->pn = n.pn;
+        victim->dn = n.dn;
+        victim->work = work;
+        victim->generation = generation;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            table[i] = bucket();
+    }
+
+    // Поиск в глубину с порогами: узел раскрывается, пока pn < th_pn и dn < th_dn
+    void mid(const vector<vector<POS_T>> &mtx, const bool color, const int plies, const uint32_t th_pn,
+             const uint32_t th_dn, entry &n)
+    {
+        const size_t start_nodes = nodes++;
+        const bool is_or = attacker(plies);
+        vector<vector<move_pos>> turns;
+        vector<move_pos> path;
+        rules->find_full_turns(mtx, color, path, turns);
+        if (turns.empty() || plies == 0)
+        {
+            // Ходов нет: проиграл тот, кто ходит. Полуходы кончились: выигрыша нет
+            const bool win = turns.empty() && !is_or;
+            n.pn = win ? 0 : INF_PN;
+            n.dn = win ? INF_PN : 0;
+            store(mtx, color, plies, n, 1);
+            return;
+        }
+        vector<vector<vector<POS_T>>> children;
+        children.reserve(turns.size());
+        for (const auto &turn : turns)
+        {
+            auto cur = mtx;
+            for (const auto &step : turn)
+                cur = rules->make_turn(cur, step);
+            children.push_back(cur);
+        }
+        vector<entry> child(children.size());
+        while (true)
+        {
+            // pn и dn узла по детям; в узле атакующего pn - минимум, dn - сумма, у защищающегося наоборот
+            uint32_t min_value = INF_PN, sum = 0;
+            size_t best = 0;
+            uint32_t second = INF_PN;
+            for (size_t k = 0; k < children.size(); ++k)
+            {
+                child[k] = probe(children[k], !color, plies - 1);
+                const uint32_t value = is_or ? child[k].pn : child[k].dn;
+                const uint32_t other = is_or ? child[k].dn : child[k].pn;
+                if (value < min_value)
+                {
+                    second = min_value;
+                    min_value = value;
+                    best = k;
+                }
+                else if (value < second)
+                {
+                    second = value;
+                }
+                sum = add(sum, other);
+            }
+            n.pn = is_or ? min_value : sum;
+            n.dn = is_or ? sum : min_value;
+            if (n.pn >= th_pn || n.dn >= th_dn || nodes >= limit)
+                break;
+            // Порог выбранного ребёнка: пока он лучший и пока узел не превысит свой порог
+            entry &c = child[best];
+            uint32_t c_th_pn, c_th_dn;
+            if (is_or)
+            {
+                c_th_pn = min(th_pn, add(second, 1));
+                c_th_dn = add(th_dn - n.dn, c.dn);
+            }
+            else
+            {
+                c_th_dn = min(th_dn, add(second, 1));
+                c_th_pn = add(th_pn - n.pn, c.pn);
+            }
+            mid(children[best], !color, plies - 1, c_th_pn, c_th_dn, c);
+        }
+        store(mtx, color, plies, n, uint32_t(min<size_t>(nodes - start_nodes, UINT32_MAX)));
+    }
+
+    // Выигрышная линия по таблице: доказанный ход атакующего, у защищающегося - самая долгая защита
+    // (больше всего работы). Если нужная запись вытеснена из таблицы, линия обрывается
+    void make_line(vector<vector<POS_T>> mtx, bool color, int plies, vector<move_pos> &line)
+    {
+        while (plies > 0)
+        {
+            vector<vector<move_pos>> turns;
+            vector<move_pos> path;
+            rules->find_full_turns(mtx, color, path, turns);
+            const bool is_or = attacker(plies);
+            int chosen = -1;
+            uint32_t chosen_work = 0;
+            for (size_t k = 0; k < turns.size(); ++k)
+            {
+                auto cur = mtx;
+                for (const auto &step : turns[k])
+                    cur = rules->make_turn(cur, step);
+                const entry e = probe(cur, !color, plies - 1);
+                if (e.pn != 0)
+                {
+                    if (is_or)
+                        continue;
+                    return;
+                }
+                if (chosen == -1 || e.work > chosen_work)
+                {
+                    chosen = int(k);
+                    chosen_work = e.work;
+                }
+                if (is_or)
+                    break;
+            }
+            if (chosen == -1)
+                return;
+            for (const auto &step : turns[chosen])
+            {
+                line.push_back(step);
+                mtx = rules->make_turn(mtx, step);
+            }
+            color = !color;
+            --plies;
+        }
+    }
+
+  private:
+    Rules *rules = nullptr;
+    unique_ptr<bucket[]> table;
+    size_t mask = 0;
+    size_t limit = 0;
+    int root_plies = 0;
+    uint16_t generation = 0; // номер текущего solve
+};
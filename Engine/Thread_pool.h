@@ -0,0 +1,154 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Пул потоков с перехватом задач (work stealing). У каждого потока своя очередь: задачи из внешних потоков
+// раскладываются по очередям по кругу, задачи из потока пула попадают в его очередь. Поток берёт задачи
+// из начала своей очереди, а освободившийся поток забирает задачи из начала чужих очередей, так что и
+// перехваченные задачи выполняются в порядке поступления. Общей блокировки на пути задачи нет: счётчики
+// задач атомарные, мьютекс sleep_mtx берётся, только когда поток засыпает без работы или его надо разбудить.
+class Thread_pool
+{
+  public:
+    Thread_pool(unsigned threads = 0)
+    {
+        if (!threads)
+            threads = max(1u, thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i)
+            queues.emplace_back(new worker_queue);
+        for (unsigned i = 0; i < threads; ++i)
+            workers.emplace_back(&Thread_pool::work, this, i);
+    }
+
+    // Оставшиеся в очередях задачи выполняются до выхода потоков
+    ~Thread_pool()
+    {
+        {
+            lock_guard<mutex> lock(sleep_mtx);
+            done = true;
+        }
+        sleep_cv.notify_all();
+        for (auto &w : workers)
+            w.join();
+    }
+
+    void submit(function<void()> task)
+    {
+        size_t id = (worker_owner() == this) ? worker_id() : next_queue++ % queues.size();
+        active.fetch_add(1);
+        {
+            lock_guard<mutex> lock(queues[id]->mtx);
+            queues[id]->tasks.push_back(move(task));
+        }
+        // Спящий поток проверяет pending под sleep_mtx после увеличения sleepers, поэтому задача не теряется
+        pending.fetch_add(1);
+        if (sleepers.load() > 0)
+        {
+            lock_guard<mutex> lock(sleep_mtx);
+            sleep_cv.notify_one();
+        }
+    }
+
+    // Ждёт выполнения всех задач (вызывать не из потока пула)
+    void wait_idle()
+    {
+        unique_lock<mutex> lock(empty_mtx);
+        empty_cv.wait(lock, [this]() { return active.load() == 0; });
+    }
+
+    unsigned size() const
+    {
+        return unsigned(workers.size());
+    }
+
+    // Номер потока пула, в котором выполняется текущая задача
+    static size_t worker_id()
+    {
+        return current_id();
+    }
+
+  private:
+    struct worker_queue
+    {
+        mutex mtx;
+        deque<function<void()>> tasks;
+    };
+
+    static size_t &current_id()
+    {
+        static thread_local size_t id = 0;
+        return id;
+    }
+
+    static const Thread_pool *&worker_owner()
+    {
+        static thread_local const Thread_pool *owner = nullptr;
+        return owner;
+    }
+
+    // Сначала своя очередь, затем чужие по кругу, всегда с начала
+    bool pop(const size_t id, function<void()> &task)
+    {
+        for (size_t k = 0; k < queues.size(); ++k)
+        {
+            worker_queue &q = *queues[(id + k) % queues.size()];
+            lock_guard<mutex> lock(q.mtx);
+            if (!q.tasks.empty())
+            {
+                task = move(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(const size_t id)
+    {
+        current_id() = id;
+        worker_owner() = this;
+        function<void()> task;
+        while (true)
+        {
+            if (pop(id, task))
+            {
+                // pending может ненадолго стать отрицательным: задачу взяли до увеличения счётчика в submit
+                pending.fetch_sub(1);
+                task();
+                task = nullptr;
+                if (active.fetch_sub(1) == 1)
+                {
+                    lock_guard<mutex> lock(empty_mtx);
+                    empty_cv.notify_all();
+                }
+                continue;
+            }
+            unique_lock<mutex> lock(sleep_mtx);
+            sleepers.fetch_add(1);
+            sleep_cv.wait(lock, [this]() { return done || pending.load() > 0; });
+            sleepers.fetch_sub(1);
+            if (done && pending.load() <= 0)
+                return;
+        }
+    }
+
+  private:
+    vector<unique_ptr<worker_queue>> queues;
+    vector<thread> workers;
+    atomic<size_t> next_queue{0};
+    atomic<int64_t> pending{0};  // задачи в очередях
+    atomic<int64_t> active{0};   // задачи в очередях и выполняемые (для wait_idle)
+    atomic<unsigned> sleepers{0}; // потоки, ждущие задач на sleep_cv
+    mutex sleep_mtx, empty_mtx;
+    condition_variable sleep_cv, empty_cv;
+    bool done = false;
+};
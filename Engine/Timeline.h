@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Временная шкала работы программы в формате Chrome trace events (JSON), открывается в Perfetto или
+// chrome://tracing. Участок кода отмечается макросом TIMELINE_ZONE("имя") - время от него до конца блока.
+// Пока запись не включена (Timeline::start), участок стоит одну проверку флага; при сборке с -DNO_TIMELINE
+// макрос пустой. Каждый поток пишет в свой буфер без блокировок (не больше max_events событий), файл
+// записывается Timeline::write, когда отмеченные участки уже закончились.
+class Timeline
+{
+  public:
+    struct event
+    {
+        const char *name; // строковая константа
+        int64_t start_ns, duration_ns;
+    };
+
+    // Включает запись
+    static void start(const string &path, const size_t max_events)
+    {
+        state &s = get();
+        lock_guard<mutex> lock(s.mtx);
+        s.path = path;
+        s.max_events = max_events;
+        s.origin = chrono::steady_clock::now();
+        s.enabled.store(true, memory_order_release);
+    }
+
+    static bool enabled()
+    {
+        return get().enabled.load(memory_order_relaxed);
+    }
+
+    static int64_t now_ns()
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - get().origin).count();
+    }
+
+    // Событие текущего потока
+    static void record(const char *name, const int64_t start_ns, const int64_t duration_ns)
+    {
+        thread_buffer &b = buffer();
+        if (b.events.size() < get().max_events)
+            b.events.push_back({name, start_ns, duration_ns});
+        else
+            ++b.dropped;
+    }
+
+    // Имя текущего потока на шкале
+    static void thread_name(const string &name)
+    {
+        buffer().name = name;
+    }
+
+    // Записывает файл и выключает запись. false - файл не открылся или запись не была включена
+    static bool write()
+    {
+        state &s = get();
+        if (!s.enabled.exchange(false))
+            return false;
+        lock_guard<mutex> lock(s.mtx);
+        ofstream fout(s.path, ios::trunc);
+        if (!fout)
+            return false;
+        fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto &b : s.buffers)
+        {
+            fout << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+                 << ",\"args\":{\"name\":\"" << (b->name.empty() ? "thread " + to_string(b->tid) : b->name) << "\"}}";
+            first = false;
+            for (const auto &e : b->events)
+                fout << ",\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid
+                     << ",\"ts\":" << e.start_ns / 1000 << '.' << e.start_ns % 1000 / 100
+                     << ",\"dur\":" << e.duration_ns / 1000 << '.' << e.duration_ns % 1000 / 100 << "}";
+            if (b->dropped)
+                fout << ",\n{\"name\":\"dropped " << b->dropped << " events\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,"
+                     << "\"tid\":" << b->tid << ",\"ts\":" << now_ns() / 1000 << "}";
+        }
+        fout << "\n]}\n";
+        return bool(fout);
+    }
+
+  private:
+    struct thread_buffer
+    {
+        unsigned tid = 0;
+        string name;
+        vector<event> events;
+        size_t dropped = 0;
+    };
+
+    struct state
+    {
+        atomic<bool> enabled{false};
+        mutex mtx;
+        string path;
+        size_t max_events = 0;
+        chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+        vector<unique_ptr<thread_buffer>> buffers; // буферы остаются и после завершения потока
+    };
+
+    static state &get()
+    {
+        static state s;
+        return s;
+    }
+
+    // Буфер текущего потока, создаётся при первом событии
+    static thread_buffer &buffer()
+    {
+        thread_local thread_buffer *current = nullptr;
+        if (!current)
+        {
+            state &s = get();
+            lock_guard<mutex> lock(s.mtx);
+            s.buffers.emplace_back(new thread_buffer());
+            current = s.buffers.back().get();
+            current->tid = unsigned(s.buffers.size());
+        }
+        return *current;
+    }
+};
+
+// Участок временной шкалы от создания до конца блока
+class Timeline_zone
+{
+  public:
+    explicit Timeline_zone(const char *name) : name(name), start_ns(Timeline::enabled() ? Timeline::now_ns() : -1)
+    {
+    }
+
+    ~Timeline_zone()
+    {
+        if (start_ns >= 0 && Timeline::enabled())
+            Timeline::record(name, start_ns, Timeline::now_ns() - start_ns);
+    }
+
+    Timeline_zone(const Timeline_zone &) = delete;
+    Timeline_zone &operator=(const Timeline_zone &) = delete;
+
+  private:
+    const char *name;
+    int64_t start_ns;
+};
+
+#ifdef NO_TIMELINE
+#define TIMELINE_ZONE(name)
+#else
+#define TIMELINE_CONCAT_(a, b) a##b
+#define TIMELINE_CONCAT(a, b) TIMELINE_CONCAT_(a, b)
+#define TIMELINE_ZONE(name) Timeline_zone TIMELINE_CONCAT(timeline_zone_, __LINE__)(name)
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Score.h"
+
+using namespace std;
+
+// Таблица транспозиций ограниченного размера. Может использоваться несколькими потоками одновременно:
+// запись без блокировок, ключ хранится как key ^ данные, поэтому разорванная запись просто не находится.
+// Корзина из двух записей: первая заменяется только более глубоким результатом, вторая - всегда.
+class Transposition
+{
+  public:
+    enum bound : uint8_t
+    {
+        EXACT = 0,
+        LOWER = 1, // настоящая оценка не меньше сохранённой
+        UPPER = 2  // настоящая оценка не больше сохранённой
+    };
+
+    struct entry
+    {
+        SCORE_T score = 0;   // выигрыш и проигрыш - через сколько ходов от этого узла (score_to_tt)
+        int draft = 0;       // оставшаяся глубина поиска
+        bound flag = EXACT;
+        int8_t from = -1;    // лучший ход узла (номера тёмных клеток), -1 если нет
+        int8_t to = -1;
+    };
+
+    Transposition(const size_t mb)
+    {
+        size_t buckets = 1;
+        while (buckets * 2 * sizeof(bucket) <= mb * 1024 * 1024)
+            buckets *= 2;
+        mask = buckets - 1;
+        table.reset(new bucket[buckets]);
+    }
+
+    bool probe(const uint64_t key, entry &res) const
+    {
+        const bucket &b = table[key & mask];
+        for (const slot &s : b.slots)
+        {
+            const uint64_t data = s.data.load(memory_order_relaxed);
+            if ((s.key.load(memory_order_relaxed) ^ data) == key && data)
+            {
+                res = unpack(data);
+                hits.fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(const uint64_t key, const entry &e)
+    {
+        bucket &b = table[key & mask];
+        const uint64_t data = pack(e);
+        slot &deep = b.slots[0];
+        const uint64_t old = deep.data.load(memory_order_relaxed);
+        bool same = (deep.key.load(memory_order_relaxed) ^ old) == key;
+        slot &s = (!old || same || e.draft >= unpack(old).draft) ? deep : b.slots[1];
+        s.key.store(key ^ data, memory_order_relaxed);
+        s.data.store(data, memory_order_relaxed);
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            for (slot &s : table[i].slots)
+            {
+                s.key.store(0, memory_order_relaxed);
+                s.data.store(0, memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t size_mb() const
+    {
+        return (mask + 1) * sizeof(bucket) / (1024 * 1024);
+    }
+
+    size_t hit_count() const
+    {
+        return hits.load(memory_order_relaxed);
+    }
+
+    // Ключ Зобриста позиции: фигуры, кто ходит и за кого играет бот (оценки считаются с его стороны)
+    static uint64_t hash(const vector<vector<POS_T>> &mtx, const bool color, const bool bot_color)
+    {
+        const auto &z = zobrist();
+        const POS_T n = POS_T(mtx.size());
+        uint64_t key = z[0][color] ^ z[1][bot_color];
+        for (POS_T i = 0; i < n; ++i)
+        {
+            for (POS_T j = (i % 2 == 0); j < n; j += 2)
+            {
+                if (mtx[i][j])
+                    key ^= z[mtx[i][j] + 1][i * (n / 2) + j / 2];
+            }
+        }
+        return key;
+    }
+
+  private:
+    struct slot
+    {
+        atomic<uint64_t> key{0}, data{0};
+    };
+    struct bucket
+    {
+        slot slots[2];
+    };
+
+    // Запись хранится в одном слове: оценка (32 бита), глубина (8), тип с признаком записи (8), откуда (8), куда (8)
+    static const uint8_t STORED = 4;
+
+    static uint64_t pack(const entry &e)
+    {
+        return uint64_t(uint32_t(e.score)) | uint64_t(uint8_t(e.draft)) << 32 | uint64_t(e.flag | STORED) << 40 |
+               uint64_t(uint8_t(e.from)) << 48 | uint64_t(uint8_t(e.to)) << 56;
+    }
+
+    static entry unpack(const uint64_t data)
+    {
+        entry e;
+        e.score = SCORE_T(uint32_t(data));
+        e.draft = uint8_t(data >> 32);
+        e.flag = bound(uint8_t(data >> 40) & ~STORED);
+        e.from = int8_t(data >> 48);
+        e.to = int8_t(data >> 56);
+        return e;
+    }
+
+    // Случайные ключи: [0] - кто ходит, [1] - цвет бота, [2..5] - тип фигуры 1..4 на тёмной клетке 0..49
+    // (доска до 10 x 10). Ключи клеток 0..31 идут первыми, поэтому ключи позиций 8 x 8 не зависят от числа клеток
+    static const vector<vector<uint64_t>> &zobrist()
+    {
+        static const vector<vector<uint64_t>> z = []() {
+            vector<vector<uint64_t>> res(6);
+            uint64_t x = 0x9e3779b97f4a7c15;
+            for (const size_t cells : {32, 50})
+            {
+                for (auto &row : res)
+                {
+                    while (row.size() < cells)
+                    {
+                        // splitmix64
+                        uint64_t y = (x += 0x9e3779b97f4a7c15);
+                        y = (y ^ (y >> 30)) * 0xbf58476d1ce4e5b9;
+                        y = (y ^ (y >> 27)) * 0x94d049bb133111eb;
+                        row.push_back(y ^ (y >> 31));
+                    }
+                }
+            }
+            return res;
+        }();
+        return z;
+    }
+
+  private:
+    unique_ptr<bucket[]> table;
+    size_t mask = 0;
+    mutable atomic<size_t> hits{0};
+};
@@ -3,8 +3,11 @@
 #include <fstream>
 #include <vector>
 
+#include "../Engine/Timeline.h"
 #include "../Models/Move.h"
 #include "../Models/Project_path.h"
+#include "Perf_overlay.h"
+#include "Texture_pack.h"
 
 #ifdef __APPLE__
     #include <SDL2/SDL.h>
@@ -21,8 +24,8 @@ class Board
 public:
     // Конструктор по умолчанию
     Board() = default;
-    // Конструктор с параметрами
-    Board(const unsigned int W, const unsigned int H) : W(W), H(H)
+    // Конструктор с параметрами. pack_path - файл пакета текстур (Game.TexturePack), пустая строка - без пакета
+    Board(const unsigned int W, const unsigned int H, const string &pack_path = "") : W(W), H(H), pack_path(pack_path)
     {
     }
 
@@ -65,18 +68,29 @@ public:
             return 1;
         }
 
-        // Загружает текстуры для элементов
-        board = IMG_LoadTexture(ren, board_path.c_str());
-        w_piece = IMG_LoadTexture(ren, piece_white_path.c_str());
-        b_piece = IMG_LoadTexture(ren, piece_black_path.c_str());
-        w_queen = IMG_LoadTexture(ren, queen_white_path.c_str());
-        b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
-        back = IMG_LoadTexture(ren, back_path.c_str());
-        replay = IMG_LoadTexture(ren, replay_path.c_str());
-        if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
+        // Загружает все текстуры один раз: из пакета или параллельным декодированием PNG
         {
-            print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
-            return 1;
+            TIMELINE_ZONE("load_textures");
+            vector<SDL_Texture *> textures;
+            string error;
+            Texture_pack pack;
+            bool ok = pack.load(ren, textures_path, TEXTURE_NAMES, pack_path.empty() ? "" : project_path + pack_path,
+                                textures, error);
+            board = textures[TEX_BOARD];
+            w_piece = textures[TEX_WHITE_PIECE];
+            b_piece = textures[TEX_BLACK_PIECE];
+            w_queen = textures[TEX_WHITE_QUEEN];
+            b_queen = textures[TEX_BLACK_QUEEN];
+            back = textures[TEX_BACK];
+            replay = textures[TEX_REPLAY];
+            white_wins = textures[TEX_WHITE_WINS];
+            black_wins = textures[TEX_BLACK_WINS];
+            draw = textures[TEX_DRAW];
+            if (!ok)
+            {
+                print_exception("Texture_pack can't load textures from " + textures_path + ": " + error);
+                return 1;
+            }
         }
 
         // Устанавливаем размер окна в рендере
@@ -151,13 +165,14 @@ public:
         return mtx;
     }
 
-    // Подсвечивает переданные клетки, добавляя их в список выделенных
-    void highlight_cells(vector<pair<POS_T, POS_T>> cells)
+    // Подсвечивает переданные клетки, добавляя их в список выделенных.
+    // hint - подсказка (клетки лучших ходов анализа), рисуется отдельным цветом
+    void highlight_cells(vector<pair<POS_T, POS_T>> cells, const bool hint = false)
     {
         for (auto pos : cells)
         {
             POS_T x = pos.first, y = pos.second;
-            is_highlighted_[x][y] = 1;
+            (hint ? is_hint_ : is_highlighted_)[x][y] = 1;
         }
         rerender();
     }
@@ -168,6 +183,7 @@ public:
         for (POS_T i = 0; i < 8; ++i)
         {
             is_highlighted_[i].assign(8, 0);
+            is_hint_[i].assign(8, 0);
         }
         rerender();
     }
@@ -222,6 +238,13 @@ public:
         rerender();
     }
 
+    // Показывает или скрывает оверлей производительности
+    void toggle_overlay()
+    {
+        perf.visible = !perf.visible;
+        rerender();
+    }
+
     // Освобождает все ресурсы и завершает работу SDL
     void quit()
     {
@@ -232,6 +255,9 @@ public:
         SDL_DestroyTexture(b_queen);
         SDL_DestroyTexture(back);
         SDL_DestroyTexture(replay);
+        SDL_DestroyTexture(white_wins);
+        SDL_DestroyTexture(black_wins);
+        SDL_DestroyTexture(draw);
         SDL_DestroyRenderer(ren);
         SDL_DestroyWindow(win);
         SDL_Quit();
@@ -273,6 +299,8 @@ private:
     // Перерисовывает все игровые текстуры на экране
     void rerender()
     {
+        TIMELINE_ZONE("render");
+        const auto frame_start = chrono::steady_clock::now();
         // Очистка экрана и отрисовка доски
         SDL_RenderClear(ren);
         SDL_RenderCopy(ren, board, NULL, NULL);
@@ -321,6 +349,20 @@ private:
             }
         }
 
+        // Отрисовка подсказки внутри клетки, чтобы не закрывать подсветку ходов
+        SDL_SetRenderDrawColor(ren, 255, 215, 0, 0);
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (!is_hint_[i][j])
+                    continue;
+                SDL_Rect cell{ int(W * (j + 1) / 10 / scale) + 2, int(H * (i + 1) / 10 / scale) + 2,
+                              int(W / 10 / scale) - 4, int(H / 10 / scale) - 4 };
+                SDL_RenderDrawRect(ren, &cell);
+            }
+        }
+
         // Отрисовка активной фигуры (выбранной игроком)
         if (active_x != -1)
         {
@@ -342,27 +384,26 @@ private:
         // Отрисовка результата игры (если игра окончена)
         if (game_results != -1)
         {
-            string result_path = draw_path; // По умолчанию ничья
+            SDL_Texture* result_texture = draw; // По умолчанию ничья
             if (game_results == 1)
-                result_path = white_path; 
+                result_texture = white_wins;
             else if (game_results == 2)
-                result_path = black_path;
-            SDL_Texture* result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (result_texture == nullptr)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
+                result_texture = black_wins;
 
             // Отрисовка изображения результата в центре экрана
             SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
             SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
-            SDL_DestroyTexture(result_texture); // Освобождение памяти
         }
 
-        SDL_RenderPresent(ren); // Обновление экрана
+        perf.draw(ren, W, H);
+        {
+            TIMELINE_ZONE("present");
+            SDL_RenderPresent(ren); // Обновление экрана
+        }
+        perf.frame_presented(frame_start);
 
         // Следующие строки для работы на macOS
+        TIMELINE_ZONE("render_delay");
         SDL_Delay(10);
         SDL_Event windowEvent;
         SDL_PollEvent(&windowEvent);
@@ -380,6 +421,8 @@ private:
     int H = 0;
     // История состояний доски (для откатов ходов)
     vector<vector<vector<POS_T>>> history_mtx;
+    // Задержка клик - кадр, время кадров и бота, оверлей
+    Perf_overlay perf;
 
   private:
     SDL_Window *win = nullptr; // Указатель на окно SDL
@@ -393,19 +436,13 @@ private:
     SDL_Texture *b_queen = nullptr;
     SDL_Texture *back = nullptr;
     SDL_Texture *replay = nullptr;
+    SDL_Texture *white_wins = nullptr;
+    SDL_Texture *black_wins = nullptr;
+    SDL_Texture *draw = nullptr;
 
-    // Пути к файлам текстур
+    // Файлы текстур (в порядке загрузки в start_draw) и пакет текстур
     const string textures_path = project_path + "Textures/";
-    const string board_path = textures_path + "board.png";
-    const string piece_white_path = textures_path + "piece_white.png";
-    const string piece_black_path = textures_path + "piece_black.png";
-    const string queen_white_path = textures_path + "queen_white.png";
-    const string queen_black_path = textures_path + "queen_black.png";
-    const string white_path = textures_path + "white_wins.png";
-    const string black_path = textures_path + "black_wins.png";
-    const string draw_path = textures_path + "draw.png";
-    const string back_path = textures_path + "back.png";
-    const string replay_path = textures_path + "replay.png";
+    string pack_path;
 
     // Координаты выбранной (активной) шашки
     int active_x = -1, active_y = -1;
@@ -413,6 +450,8 @@ private:
     int game_results = -1;
     // Матрица возможных ходов
     vector<vector<bool>> is_highlighted_ = vector<vector<bool>>(8, vector<bool>(8, 0));
+    // Матрица клеток подсказки
+    vector<vector<bool>> is_hint_ = vector<vector<bool>>(8, vector<bool>(8, 0));
     
     vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
 
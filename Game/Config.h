@@ -1,31 +0,0 @@
-#pragma once
-#include <fstream>
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
-
-#include "../Models/Project_path.h"
-
-class Config
-{
-  public:
-    Config()
-    {
-        reload();
-    }
-
-    // Загружает настройки из файла settings.json и сохраняет в объект config.
-    void reload()
-    {
-        std::ifstream fin(project_path + "settings.json");
-        fin >> config;
-        fin.close();
-    }
-    // Позволяет удобно получать значения из config по указанным ключам. Пример config("Game", "MaxNumTurns").
-    auto operator()(const string &setting_dir, const string &setting_name) const
-    {
-        return config[setting_dir][setting_name];
-    }
-
-  private:
-    json config;
-};
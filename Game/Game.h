@@ -3,18 +3,44 @@
 #include <thread>
 
 #include "../Models/Project_path.h"
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Pdn.h"
+#include "../Engine/Perf_counters.h"
 #include "Board.h"
-#include "Config.h"
 #include "Hand.h"
-#include "Logic.h"
 
 class Game
 {
   public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game()
+        : board(config("WindowSize", "Width"), config("WindowSize", "Hight"), string(config("Game", "TexturePack"))),
+          hand(&board), logic(&config)
     {
         ofstream fout(project_path + "log.txt", ios_base::trunc);
         fout.close();
+        board.perf.visible = config("Game", "PerfOverlay");
+        const string timeline_file = config("Game", "TimelineFile");
+        if (!timeline_file.empty())
+        {
+            Timeline::start(project_path + timeline_file, size_t(config("Game", "TimelineEvents")));
+            Timeline::thread_name("main");
+        }
+        if (config("Game", "PerfCounters"))
+        {
+            counters.reset(new Perf_counters);
+            if (!counters->available())
+            {
+                ofstream fout(project_path + "log.txt", ios_base::app);
+                fout << "Perf counters unavailable: " << counters->error() << "\n";
+            }
+        }
+    }
+
+    // Временная шкала (Game.TimelineFile) записывается при выходе
+    ~Game()
+    {
+        Timeline::write();
     }
 
     // to start checkers
@@ -26,13 +52,18 @@ class Game
         // Проверка повтор или новая игра
         if (is_replay)
         {
-            logic = Logic(&board, &config);
-            config.reload();
+            // Бот пересоздаётся, только если изменились настройки, иначе таблицы и сеть остаются
+            if (config.reload())
+                logic = Logic(&config);
+            else
+                logic.new_game();
             board.redraw();
+            log_time("Replay restart time", replay_start);
         }
         else
         {
             board.start_draw();
+            log_time("Start-up time (first frame)", created);
         }
         is_replay = false;
 
@@ -45,7 +76,7 @@ class Game
         while (++turn_num < Max_turns)
         {
             beat_series = 0;
-            logic.find_turns(turn_num % 2);
+            logic.find_turns(turn_num % 2, board.get_board());
             if (logic.turns.empty())
                 break;
             // Считывание настроек 
@@ -62,6 +93,7 @@ class Game
                 else if (resp == Response::REPLAY)
                 {
                     is_replay = true;
+                    replay_start = chrono::steady_clock::now();
                     break;
                 }
                 else if (resp == Response::BACK)
@@ -87,15 +119,15 @@ class Game
         // Время окончания игры
         auto end = chrono::steady_clock::now();
         // Запись в log.txt время игры. 
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-        fout.close();
+        {
+            TIMELINE_ZONE("log_write");
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+            fout << board.perf.summary() << "\n";
+            fout.close();
+        }
 
-        if (is_replay)
-            return play();
-        if (is_quit)
-            return 0;
-        // Определение результатов игры и ожидание действий пользователя.
+        // Определение результатов игры
         int res = 2;
         if (turn_num == Max_turns)
         {
@@ -105,20 +137,60 @@ class Game
         {
             res = 1;
         }
+        // Прерванная партия записывается как незаконченная
+        save_pdn(is_replay || is_quit ? -1 : res);
+
+        if (is_replay)
+            return play();
+        if (is_quit)
+            return 0;
+        // Ожидание действий пользователя.
         board.show_final(res);
         auto resp = hand.wait();
         if (resp == Response::REPLAY)
         {
             is_replay = true;
+            replay_start = chrono::steady_clock::now();
             return play();
         }
         return res;
     }
 
   private:
+    // Пишет в log.txt время от start до текущего момента
+    void log_time(const string &what, const chrono::steady_clock::time_point start) const
+    {
+        TIMELINE_ZONE("log_write");
+        auto end = chrono::steady_clock::now();
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << what << ": " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+        fout.close();
+    }
+
+    // Дописывает сыгранную партию в PDN файл Game.PdnFile (если задан)
+    void save_pdn(const int res)
+    {
+        const string pdn_file = config("Game", "PdnFile");
+        if (pdn_file.empty() || board.history_mtx.size() < 2)
+            return;
+        time_t now = time(0);
+        char date[16];
+        strftime(date, sizeof(date), "%Y.%m.%d", localtime(&now));
+        auto player = [this](const string &color) {
+            return config("Bot", "Is" + color + "Bot") ? "Bot level " + to_string(int(config("Bot", color + "BotLevel")))
+                                                      : string("Player");
+        };
+        vector<pair<string, string>> tags = {
+            {"Event", "Checkers"}, {"Date", date}, {"White", player("White")}, {"Black", player("Black")}};
+        ofstream fout(project_path + pdn_file, ios_base::app);
+        write_pdn(fout, make_pdn_game(board.history_mtx, res, tags));
+        fout.close();
+    }
+
     // Функция для выполнения хода бота
     void bot_turn(const bool color)
     {
+        TIMELINE_ZONE("bot_turn");
         auto start = chrono::steady_clock::now(); // Засекаем время начала хода
 
         auto delay_ms = config("Bot", "BotDelayMS"); // Задержка для имитации "раздумий" бота
@@ -126,8 +198,15 @@ class Game
         // Создаем отдельный поток для задержки, чтобы не блокировать основной поток
         thread th(SDL_Delay, delay_ms);
 
-        // Поиск лучшего хода для бота
-        auto turns = logic.find_best_turns(color);
+        // Поиск лучшего хода для бота: по уровню силы (бюджет узлов), если он задан, иначе по глубине
+        const int skill = config("Bot", string(color ? "Black" : "White") + "BotSkill");
+        if (counters)
+            counters->start();
+        auto turns = skill > 0 ? logic.find_skill_turns(board.get_board(), color, skill)
+                               : logic.find_best_turns(board.get_board(), color);
+        const auto search_end = chrono::steady_clock::now();
+        const auto sample = counters ? counters->stop() : Perf_counters::sample();
+        board.perf.bot_think(chrono::duration<double, milli>(search_end - start).count());
         th.join(); // Ожидаем завершения потока с задержкой
 
         bool is_first = true;
@@ -147,20 +226,58 @@ class Game
         auto end = chrono::steady_clock::now(); // Засекаем время окончания хода
 
         // Логируем время выполнения хода
+        TIMELINE_ZONE("log_write");
         ofstream fout(project_path + "log.txt", ios_base::app);
         fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+        // Аппаратные счётчики поиска хода (Game.PerfCounters)
+        if (!sample.empty())
+        {
+            const double sec = chrono::duration<double>(search_end - start).count();
+            fout << "Bot search counters: nodes " << logic.nodes << ", "
+                 << int64_t(sec > 0 ? logic.nodes / sec : 0) << " nodes/s, " << sample.summary(logic.nodes, "node")
+                 << "\n";
+        }
+        fout.close();
+    }
+
+    // Подсказка игроку: клетки лучших ходов анализа multi_pv (Game.HintLines), ходы с оценками пишутся в log.txt
+    vector<pair<POS_T, POS_T>> find_hints(const bool color)
+    {
+        vector<pair<POS_T, POS_T>> cells;
+        const int hint_lines = config("Game", "HintLines");
+        if (hint_lines <= 0)
+            return cells;
+        TIMELINE_ZONE("hints");
+        search_limits limits;
+        limits.level = config("Game", "HintLevel");
+        auto lines = logic.multi_pv(board.get_board(), color, hint_lines, limits);
+        logic.find_turns(color, board.get_board()); // ходы игрока для проверки выбора
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        for (const auto &line : lines)
+        {
+            for (const auto &step : line.turn)
+            {
+                cells.emplace_back(step.x, step.y);
+                cells.emplace_back(step.x2, step.y2);
+            }
+            fout << "Hint: " << turn_to_string(line.turn) << " score " << line.score << " pv " << steps_to_string(line.pv)
+                 << "\n";
+        }
         fout.close();
+        return cells;
     }
 
     Response player_turn(const bool color)
     {
-        // Подсветка доступных для хода клеток
+        // Подсветка доступных для хода клеток и подсказки
         vector<pair<POS_T, POS_T>> cells;
         for (auto turn : logic.turns)
         {
             cells.emplace_back(turn.x, turn.y);
         }
+        const auto hints = find_hints(color);
         board.highlight_cells(cells);
+        board.highlight_cells(hints, true);
         move_pos pos = {-1, -1, -1, -1};
         POS_T x = -1, y = -1;
         // Обработка выбора клетки 
@@ -197,6 +314,7 @@ class Game
                     board.clear_active();
                     board.clear_highlight();
                     board.highlight_cells(cells);
+                    board.highlight_cells(hints, true);
                 }
                 x = -1;
                 y = -1;
@@ -215,6 +333,7 @@ class Game
                 }
             }
             board.highlight_cells(cells2);
+            board.highlight_cells(hints, true);
         }
 
         // Выполнение хода 
@@ -228,7 +347,7 @@ class Game
         
         while (true)
         {
-            logic.find_turns(pos.x2, pos.y2);
+            logic.find_turns(pos.x2, pos.y2, board.get_board());
             if (!logic.have_beats)
                 break;
 
@@ -272,10 +391,13 @@ class Game
     }
     
   private:
+    chrono::steady_clock::time_point created = chrono::steady_clock::now(); // до создания остальных членов
+    chrono::steady_clock::time_point replay_start;
     Config config;
     Board board;
     Hand hand;
     Logic logic;
+    unique_ptr<Perf_counters> counters; // Game.PerfCounters
     int beat_series;
     bool is_replay = false;
 };
@@ -15,15 +15,18 @@ class Hand
     // Метод для получения выбранной клетки и обработки событий
     tuple<Response, POS_T, POS_T> get_cell() const
     {
+        TIMELINE_ZONE("wait_input");
         SDL_Event windowEvent; // Структура для хранения событий SDL
         Response resp = Response::OK;
         int x = -1, y = -1; // Координаты курсора мыши
         int xc = -1, yc = -1; // Координаты клетки на доске
+        board->perf.drop_input(); // прошлый клик, не изменивший изображение
         
         while (true)
         {
             if (SDL_PollEvent(&windowEvent))
             {
+                TIMELINE_ZONE("event");
                 switch (windowEvent.type)
                 {
                 // Обработка выхода
@@ -32,6 +35,7 @@ class Hand
                     break;
                 // Вычисляются координаты клетки на доске
                 case SDL_MOUSEBUTTONDOWN:
+                    board->perf.input(windowEvent.button.timestamp);
                     x = windowEvent.motion.x;
                     y = windowEvent.motion.y;
                     xc = int(y / (board->H / 10) - 1);
@@ -54,8 +58,14 @@ class Hand
                     {
                         xc = -1;
                         yc = -1;
+                        board->perf.drop_input();
                     }
                     break;
+                // F3 - оверлей производительности
+                case SDL_KEYDOWN:
+                    if (windowEvent.key.keysym.sym == SDLK_F3)
+                        board->toggle_overlay();
+                    break;
                 // Обработка изменения размера окна
                 case SDL_WINDOWEVENT:
                     if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
@@ -73,12 +83,15 @@ class Hand
     // Метод ожидает действий пользователя
     Response wait() const
     {
+        TIMELINE_ZONE("wait_input");
         SDL_Event windowEvent;
         Response resp = Response::OK;
+        board->perf.drop_input();
         while (true)
         {
             if (SDL_PollEvent(&windowEvent))
             {
+                TIMELINE_ZONE("event");
                 switch (windowEvent.type)
                 {
                 case SDL_QUIT:
@@ -87,7 +100,12 @@ class Hand
                 case SDL_WINDOWEVENT_SIZE_CHANGED:
                     board->reset_window_size();
                     break;
+                case SDL_KEYDOWN:
+                    if (windowEvent.key.keysym.sym == SDLK_F3)
+                        board->toggle_overlay();
+                    break;
                 case SDL_MOUSEBUTTONDOWN: {
+                    board->perf.input(windowEvent.button.timestamp);
                     int x = windowEvent.motion.x;
                     int y = windowEvent.motion.y;
                     int xc = int(y / (board->H / 10) - 1);
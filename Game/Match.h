@@ -0,0 +1,267 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <random>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Pdn.h"
+#include "../Engine/Thread_pool.h"
+#include "../Models/Project_path.h"
+
+using namespace std;
+
+// Общие ресурсы партий окна наблюдения: пул потоков поиска, Logic каждого потока пула (с общей таблицей
+// транспозиций, как в Tools/Server.h) и Logic основного потока для генерации и выполнения ходов
+struct match_pool
+{
+    Thread_pool *pool = nullptr;
+    vector<unique_ptr<Logic>> logics;
+    unique_ptr<Logic> rules;
+    atomic<bool> stop{false}; // прерывает поиски при закрытии окна
+};
+
+// Партия бот против бота в виде конечного автомата для окна наблюдения (Game/Spectator.h). В отличие от
+// Game::play, step() никогда не ждёт: поиск хода выполняется в пуле потоков, а шаги хода (серия взятий)
+// показываются по одному не чаще, чем раз в Spectator.MoveDelayMS. Поэтому один поток ведёт десятки партий.
+// Доска N играет партии N, N + Games, N + 2 * Games, ...: дебют партии определяется Seed + номер партии.
+class Match
+{
+  public:
+    enum class State
+    {
+        START,    // новая партия: начальная позиция и случайный дебют
+        SEARCH,   // нужно начать поиск хода
+        THINKING, // поиск выполняется в пуле
+        MOVE,     // показ шагов найденного хода
+        FINISHED  // партия окончена, ожидание перезапуска
+    };
+
+    Match(Config *config, match_pool *shared, const uint32_t game_id, const uint32_t games)
+        : config(config), shared(shared), game_id(game_id), games(games)
+    {
+        max_turns = (*config)("Game", "MaxNumTurns");
+        opening_turns = (*config)("Spectator", "RandomOpeningTurns");
+        move_delay = chrono::milliseconds(int((*config)("Spectator", "MoveDelayMS")));
+        restart_delay = chrono::milliseconds(int((*config)("Spectator", "RestartDelayMS")));
+        restart = (*config)("Spectator", "Restart");
+        pdn_file = string((*config)("Spectator", "PdnFile"));
+        const unsigned base = (*config)("Spectator", "Seed");
+        seed = base ? base : unsigned(time(0));
+    }
+
+    // Поиск в пуле ссылается на объект, поэтому партия не копируется и не перемещается
+    Match(const Match &) = delete;
+    Match &operator=(const Match &) = delete;
+
+    // Продвигает партию к моменту now. true - позиция или итог изменились и доску нужно перерисовать
+    bool step(const chrono::steady_clock::time_point now)
+    {
+        switch (state)
+        {
+        case State::START:
+            start_game();
+            next_step = now + move_delay;
+            state = State::SEARCH;
+            return true;
+        case State::SEARCH:
+            return start_search(now);
+        case State::THINKING:
+            if (!ready.load(memory_order_acquire))
+                return false;
+            ready.store(false, memory_order_relaxed);
+            new_think = true;
+            steps = move(found);
+            step_index = 0;
+            if (steps.empty()) // поиск прерван остановкой
+            {
+                state = State::SEARCH;
+                return false;
+            }
+            state = State::MOVE;
+            // Шаг показывается сразу, если поиск был дольше задержки
+            [[fallthrough]];
+        case State::MOVE:
+            if (now < next_step)
+                return false;
+            play_step(steps[step_index]);
+            next_step = now + move_delay;
+            if (++step_index == steps.size())
+            {
+                ++turn_num;
+                state = State::SEARCH;
+            }
+            return true;
+        case State::FINISHED:
+            if (!restart || now - finished_at < restart_delay)
+                return false;
+            game_id += games;
+            state = State::START;
+            return step(now);
+        }
+        return false;
+    }
+
+    // Время последнего поиска в мс (для оверлея), false - с прошлого вызова поисков не было
+    bool take_think_ms(double &ms)
+    {
+        if (!new_think)
+            return false;
+        new_think = false;
+        ms = think_ms;
+        return true;
+    }
+
+    State get_state() const
+    {
+        return state;
+    }
+
+    const vector<vector<POS_T>> &get_board() const
+    {
+        return mtx;
+    }
+
+    // Последний показанный шаг (x = -1 - шагов ещё не было)
+    const move_pos &get_last_step() const
+    {
+        return last_step;
+    }
+
+    // Итог законченной партии: 0 - ничья, 1 - выиграли белые, 2 - выиграли черные
+    int get_result() const
+    {
+        return result;
+    }
+
+    uint32_t get_game_id() const
+    {
+        return game_id;
+    }
+
+  private:
+    void start_game()
+    {
+        Logic &rules = *shared->rules;
+        mtx = Logic::start_mtx();
+        history = {mtx};
+        last_step = move_pos(-1, -1, -1, -1);
+        turn_num = 0;
+        // Случайный дебют для разнообразия партий (как в Tools/selfplay.cpp), ходы не показываются по шагам
+        default_random_engine opening_eng(seed + game_id);
+        for (; turn_num < opening_turns && turn_num < max_turns; ++turn_num)
+        {
+            rules.find_turns(turn_num % 2, mtx);
+            if (rules.turns.empty())
+                break;
+            move_pos turn = rules.turns[opening_eng() % rules.turns.size()];
+            play_step(turn);
+            while (turn.xb != -1)
+            {
+                rules.find_turns(turn.x2, turn.y2, mtx);
+                if (!rules.have_beats)
+                    break;
+                turn = rules.turns[opening_eng() % rules.turns.size()];
+                play_step(turn);
+            }
+        }
+    }
+
+    // Проверяет конец партии и отправляет поиск хода в пул. true - партия закончилась
+    bool start_search(const chrono::steady_clock::time_point now)
+    {
+        const bool color = turn_num % 2;
+        Logic &rules = *shared->rules;
+        rules.find_turns(color, mtx);
+        if (turn_num >= max_turns || rules.turns.empty())
+        {
+            // Итог определяется так же, как в Game::play
+            result = turn_num >= max_turns ? 0 : (color ? 1 : 2);
+            save_pdn();
+            finished_at = now;
+            state = State::FINISHED;
+            return true;
+        }
+        const string side = color ? "Black" : "White";
+        const int level = (*config)("Bot", side + "BotLevel");
+        const int skill = (*config)("Bot", side + "BotSkill");
+        const unsigned search_seed = seed + game_id * 1000 + unsigned(turn_num);
+        state = State::THINKING;
+        shared->pool->submit([this, position = mtx, color, level, skill, search_seed]() {
+            TIMELINE_ZONE("match_search");
+            const auto start = chrono::steady_clock::now();
+            Logic &logic = *shared->logics[Thread_pool::worker_id()];
+            logic.stop_signal = &shared->stop;
+            logic.reseed(search_seed);
+            // Поиск по уровню через search: в отличие от find_best_turns он проверяет stop_signal
+            search_limits limits;
+            limits.level = level;
+            found = skill > 0 ? logic.find_skill_turns(position, color, skill) : logic.search(position, color, limits);
+            logic.stop_signal = nullptr;
+            think_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            ready.store(true, memory_order_release);
+        });
+        return false;
+    }
+
+    void play_step(const move_pos &turn)
+    {
+        mtx = shared->rules->make_turn(mtx, turn);
+        history.push_back(mtx);
+        last_step = turn;
+    }
+
+    // Дописывает партию в PDN файл Spectator.PdnFile (если задан)
+    void save_pdn() const
+    {
+        if (pdn_file.empty() || history.size() < 2)
+            return;
+        time_t now = time(0);
+        char date[16];
+        strftime(date, sizeof(date), "%Y.%m.%d", localtime(&now));
+        auto player = [this](const string &color) {
+            const int skill = (*config)("Bot", color + "BotSkill");
+            return skill > 0 ? "Bot skill " + to_string(skill)
+                             : "Bot level " + to_string(int((*config)("Bot", color + "BotLevel")));
+        };
+        vector<pair<string, string>> tags = {{"Event", "Spectator"},
+                                             {"Round", to_string(game_id + 1)},
+                                             {"Date", date},
+                                             {"White", player("White")},
+                                             {"Black", player("Black")}};
+        ofstream fout(project_path + pdn_file, ios_base::app);
+        write_pdn(fout, make_pdn_game(history, result, tags));
+    }
+
+    Config *config;
+    match_pool *shared;
+    uint32_t game_id;
+    uint32_t games; // количество досок: шаг номера партии при перезапуске
+    unsigned seed = 0;
+    int max_turns = 0;
+    int opening_turns = 0;
+    chrono::milliseconds move_delay{0};
+    chrono::milliseconds restart_delay{0};
+    bool restart = true;
+    string pdn_file;
+
+    State state = State::START;
+    int turn_num = 0;
+    int result = -1;
+    vector<vector<POS_T>> mtx;
+    vector<vector<vector<POS_T>>> history; // состояние доски после каждого шага (для PDN)
+    move_pos last_step = move_pos(-1, -1, -1, -1);
+    vector<move_pos> steps; // шаги показываемого хода
+    size_t step_index = 0;
+    chrono::steady_clock::time_point next_step;
+    chrono::steady_clock::time_point finished_at;
+
+    // Результат поиска пишет поток пула, ready публикует его основному потоку
+    vector<move_pos> found;
+    double think_ms = 0;
+    atomic<bool> ready{false};
+    bool new_think = false; // think_ms ещё не забрано (только основной поток)
+};
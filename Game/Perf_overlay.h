@@ -0,0 +1,155 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+    #include <SDL2/SDL.h>
+#else
+    #include <SDL.h>
+#endif
+
+#include "../Models/Histogram.h"
+
+using namespace std;
+
+// Замер отзывчивости интерфейса. Клик мыши (время события SDL) ждёт первого кадра, выведенного после него
+// (SDL_RenderPresent): задержка клик - кадр и время отрисовки кадров копятся в гистограммах, а также время
+// раздумий бота. Клик, после которого кадр не выводился (мимо доски, неверная клетка), отбрасывается при
+// следующем ожидании ввода. Оверлей (F3 или Game.PerfOverlay) показывает в углу окна p50/p99 задержки,
+// FPS, время кадра и бота шрифтом 3 x 5 из прямоугольников (без библиотеки шрифтов).
+class Perf_overlay
+{
+  public:
+    bool visible = false;
+
+    // Клик: timestamp - время события SDL в мс (SDL_GetTicks), учитывает ожидание в очереди событий
+    void input(const uint32_t timestamp)
+    {
+        const uint32_t queued = SDL_GetTicks() - timestamp;
+        pending_input = chrono::steady_clock::now() - chrono::milliseconds(queued < 1000 ? queued : 0);
+        has_input = true;
+    }
+
+    // Клик не изменил изображение
+    void drop_input()
+    {
+        has_input = false;
+    }
+
+    // Кадр, который начали рисовать в start, выведен на экран
+    void frame_presented(const chrono::steady_clock::time_point start)
+    {
+        const auto now = chrono::steady_clock::now();
+        frame_time.add(chrono::duration<double, micro>(now - start).count());
+        if (has_input)
+        {
+            latency.add(chrono::duration<double, micro>(now - pending_input).count());
+            last_latency_ms = chrono::duration<double, milli>(now - pending_input).count();
+            has_input = false;
+        }
+        presents.push_back(now);
+        while (now - presents.front() > chrono::seconds(1))
+            presents.pop_front();
+    }
+
+    // Время поиска хода ботом
+    void bot_think(const double ms)
+    {
+        bot_time.add(ms * 1000);
+        last_bot_ms = ms;
+    }
+
+    // Итоги для log.txt
+    string summary() const
+    {
+        stringstream ss;
+        ss << fixed << setprecision(1) << "Click-to-present latency p50 " << latency.percentile(50) / 1000 << " p99 "
+           << latency.percentile(99) / 1000 << " millisec (" << latency.count() << " clicks), frame time p50 "
+           << frame_time.percentile(50) / 1000 << " p99 " << frame_time.percentile(99) / 1000 << " millisec ("
+           << frame_time.count() << " frames), bot think p50 " << bot_time.percentile(50) / 1000 << " p99 "
+           << bot_time.percentile(99) / 1000 << " millisec (" << bot_time.count() << " turns)";
+        return ss.str();
+    }
+
+    // Рисует оверлей в левом нижнем углу окна W x H (перед SDL_RenderPresent)
+    void draw(SDL_Renderer *ren, const int W, const int H) const
+    {
+        if (!visible)
+            return;
+        vector<string> lines(4);
+        stringstream ss;
+        ss << fixed << setprecision(1) << "CLICK P50 " << latency.percentile(50) / 1000 << " P99 "
+           << latency.percentile(99) / 1000 << " LAST " << last_latency_ms << " MS";
+        lines[0] = ss.str();
+        ss.str("");
+        ss << "FPS " << presents.size() << " FRAME P50 " << frame_time.percentile(50) / 1000 << " P99 "
+           << frame_time.percentile(99) / 1000 << " MS";
+        lines[1] = ss.str();
+        ss.str("");
+        ss << "BOT LAST " << last_bot_ms << " P50 " << bot_time.percentile(50) / 1000 << " P99 "
+           << bot_time.percentile(99) / 1000 << " MS";
+        lines[2] = ss.str();
+        ss.str("");
+        ss << "CLICKS " << latency.count() << " FRAMES " << frame_time.count() << "  F3 HIDE";
+        lines[3] = ss.str();
+
+        const int px = max(1, W / 400); // размер точки шрифта
+        size_t width = 0;
+        for (const auto &line : lines)
+            width = max(width, line.size());
+        SDL_Rect bg{0, H - int(lines.size()) * 7 * px - 2 * px, (int(width) * 4 + 2) * px, int(lines.size()) * 7 * px + 2 * px};
+        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 180);
+        SDL_RenderFillRect(ren, &bg);
+        vector<SDL_Rect> dots;
+        for (size_t l = 0; l < lines.size(); ++l)
+        {
+            for (size_t c = 0; c < lines[l].size(); ++c)
+            {
+                const uint16_t g = glyph(lines[l][c]);
+                for (int bit = 0; bit < 15; ++bit)
+                {
+                    if (g & (1 << (14 - bit)))
+                        dots.push_back({bg.x + (2 + int(c) * 4 + bit % 3) * px, bg.y + (2 + int(l) * 7 + bit / 3) * px, px, px});
+                }
+            }
+        }
+        SDL_SetRenderDrawColor(ren, 255, 255, 0, 255);
+        SDL_RenderFillRects(ren, dots.data(), int(dots.size()));
+        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+    }
+
+  private:
+    // Символ 3 x 5: строки сверху вниз по 3 бита, старший бит слева. Неизвестный символ - пробел
+    static uint16_t glyph(const char c)
+    {
+        static const uint16_t digits[10] = {0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF};
+        static const uint16_t letters[26] = {0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B, 0x5BED, 0x7497,
+                                             0x126A, 0x5BAD, 0x4927, 0x5FED, 0x6B6D, 0x2B6A, 0x6BA4, 0x2B73, 0x6BAD,
+                                             0x388E, 0x7492, 0x5B6F, 0x5B6A, 0x5BFD, 0x5AAD, 0x5A92, 0x72A7};
+        if (c >= '0' && c <= '9')
+            return digits[c - '0'];
+        if (c >= 'A' && c <= 'Z')
+            return letters[c - 'A'];
+        if (c == '.')
+            return 0x0002;
+        if (c == '-')
+            return 0x01C0;
+        return 0;
+    }
+
+  private:
+    Histogram latency;    // клик - кадр, мкс
+    Histogram frame_time; // отрисовка кадра, мкс
+    Histogram bot_time;   // раздумья бота, мкс
+    chrono::steady_clock::time_point pending_input;
+    bool has_input = false;
+    double last_latency_ms = 0;
+    double last_bot_ms = 0;
+    deque<chrono::steady_clock::time_point> presents; // кадры последней секунды
+};
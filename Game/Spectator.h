@@ -0,0 +1,344 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Thread_pool.h"
+#include "../Engine/Timeline.h"
+#include "../Engine/Transposition.h"
+#include "../Models/Project_path.h"
+#include "Match.h"
+#include "Perf_overlay.h"
+#include "Texture_pack.h"
+
+#ifdef __APPLE__
+    #include <SDL2/SDL.h>
+    #include <SDL2/SDL_image.h>
+#else
+    #include <SDL.h>
+    #include <SDL_image.h>
+#endif
+
+using namespace std;
+
+// Окно наблюдения (Spectator.Games > 0): сетка из маленьких досок, на каждой идёт своя партия бот против бота.
+// Партии - конечные автоматы Match, их поиски выполняются в пуле потоков, а основной поток только продвигает
+// партии, обрабатывает события и рисует. Каждая доска хранится в своей текстуре (render target) и
+// перерисовывается, только когда на ней изменилась позиция; кадр собирается копированием готовых текстур,
+// поэтому его стоимость почти не зависит от числа досок. Кадры выводятся не чаще 60 раз в секунду и только
+// при изменениях. F3 - оверлей производительности, как в обычной игре.
+class Spectator
+{
+  public:
+    Spectator(Config *config) : config(config)
+    {
+        ofstream fout(project_path + "log.txt", ios_base::trunc);
+        fout.close();
+        perf.visible = (*config)("Game", "PerfOverlay");
+        const string timeline_file = (*config)("Game", "TimelineFile");
+        if (!timeline_file.empty())
+        {
+            Timeline::start(project_path + timeline_file, size_t((*config)("Game", "TimelineEvents")));
+            Timeline::thread_name("main");
+        }
+    }
+
+    // Временная шкала (Game.TimelineFile) записывается при выходе
+    ~Spectator()
+    {
+        Timeline::write();
+        for (auto &cell : cells)
+            SDL_DestroyTexture(cell.texture);
+        for (auto texture : textures)
+            SDL_DestroyTexture(texture);
+        if (ren)
+            SDL_DestroyRenderer(ren);
+        if (win)
+        {
+            SDL_DestroyWindow(win);
+            SDL_Quit();
+        }
+    }
+
+    int run()
+    {
+        const unsigned games = unsigned(int((*config)("Spectator", "Games")));
+        if (start_draw())
+            return 1;
+
+        // Потоки пула используют общую таблицу вместо собственных
+        const size_t hash_mb = (*config)("Spectator", "HashMB");
+        config->set("Bot", "HashMB", 0);
+        shared_ptr<Transposition> tt;
+        if (hash_mb)
+            tt = make_shared<Transposition>(hash_mb);
+        Thread_pool pool(unsigned(int((*config)("Spectator", "Threads"))));
+        shared.pool = &pool;
+        for (unsigned i = 0; i < pool.size(); ++i)
+        {
+            shared.logics.emplace_back(new Logic(config));
+            shared.logics.back()->tt = tt;
+        }
+        shared.rules.reset(new Logic(config));
+
+        cells.resize(games);
+        for (unsigned k = 0; k < games; ++k)
+            cells[k].match.reset(new Match(config, &shared, k, games));
+        layout();
+
+        const auto frame_period = chrono::microseconds(1000000 / 60);
+        auto next_frame = chrono::steady_clock::now();
+        bool quit = false;
+        bool changed = true;
+        while (!quit)
+        {
+            // События: выход, изменение размера окна, потеря содержимого текстур, F3
+            SDL_Event event;
+            while (SDL_PollEvent(&event))
+            {
+                TIMELINE_ZONE("event");
+                if (event.type == SDL_QUIT)
+                    quit = true;
+                else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                    layout();
+                else if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET)
+                    invalidate();
+                else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3)
+                {
+                    perf.visible = !perf.visible;
+                    changed = true;
+                }
+            }
+
+            // Продвижение партий: поиски уже идут в пуле, здесь только приём ходов и показ шагов
+            {
+                TIMELINE_ZONE("step_matches");
+                const auto now = chrono::steady_clock::now();
+                for (auto &cell : cells)
+                {
+                    if (cell.match->step(now))
+                        cell.dirty = true;
+                    double ms;
+                    if (cell.match->take_think_ms(ms))
+                        perf.bot_think(ms);
+                }
+            }
+
+            for (auto &cell : cells)
+                changed |= cell.dirty;
+            // Оверлей показывает FPS и время кадра, поэтому с ним кадры выводятся постоянно
+            if (changed || perf.visible)
+            {
+                rerender();
+                changed = false;
+            }
+
+            // Не чаще 60 кадров в секунду; если кадр опоздал, следующий отсчитывается от текущего момента
+            next_frame += frame_period;
+            const auto now = chrono::steady_clock::now();
+            if (next_frame > now)
+            {
+                TIMELINE_ZONE("frame_wait");
+                SDL_Delay(uint32_t(chrono::duration_cast<chrono::milliseconds>(next_frame - now).count()));
+            }
+            else
+                next_frame = now;
+        }
+
+        // Поиски прерываются, Logic и партии живут, пока пул не закончит задачи
+        shared.stop = true;
+        pool.wait_idle();
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << "Spectator: " << games << " boards, " << pool.size() << " threads\n" << perf.summary() << "\n";
+        return 0;
+    }
+
+  private:
+    // Доска сетки: партия и текстура с её последним изображением
+    struct board_cell
+    {
+        unique_ptr<Match> match;
+        SDL_Texture *texture = nullptr;
+        SDL_Rect rect{0, 0, 0, 0};
+        bool dirty = true;
+    };
+
+    // Окно, рендер и текстуры (те же файлы и пакет, что у Board)
+    int start_draw()
+    {
+        if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+        {
+            print_exception("SDL_Init can't init SDL2 lib");
+            return 1;
+        }
+        W = (*config)("WindowSize", "Width");
+        H = (*config)("WindowSize", "Hight");
+        if (W == 0 || H == 0)
+        {
+            SDL_DisplayMode dm;
+            if (SDL_GetDesktopDisplayMode(0, &dm))
+            {
+                print_exception("SDL_GetDesktopDisplayMode can't get desctop display mode");
+                return 1;
+            }
+            W = dm.w - dm.w / 15;
+            H = dm.h - dm.h / 15;
+        }
+        win = SDL_CreateWindow("Checkers - spectator", 0, H / 30, W, H, SDL_WINDOW_RESIZABLE);
+        if (win == nullptr)
+        {
+            print_exception("SDL_CreateWindow can't create window");
+            return 1;
+        }
+        // Без PRESENTVSYNC: кадры ограничивает сам цикл, основной поток не блокируется в SDL_RenderPresent
+        ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+        if (ren == nullptr)
+        {
+            print_exception("SDL_CreateRenderer can't create renderer");
+            return 1;
+        }
+        TIMELINE_ZONE("load_textures");
+        const string pack_path = (*config)("Game", "TexturePack");
+        string error;
+        Texture_pack pack;
+        if (!pack.load(ren, textures_path, TEXTURE_NAMES, pack_path.empty() ? "" : project_path + pack_path,
+                       textures, error))
+        {
+            print_exception("Texture_pack can't load textures from " + textures_path + ": " + error);
+            return 1;
+        }
+        SDL_GetRendererOutputSize(ren, &W, &H);
+        return 0;
+    }
+
+    // Раскладка сетки по размеру окна: Spectator.Columns столбцов (0 - почти квадратная сетка), доски квадратные
+    void layout()
+    {
+        SDL_GetRendererOutputSize(ren, &W, &H);
+        const int n = int(cells.size());
+        if (!n)
+            return;
+        int columns = (*config)("Spectator", "Columns");
+        if (columns <= 0)
+            columns = int(ceil(sqrt(double(n) * W / max(1, H))));
+        columns = min(columns, n);
+        const int rows = (n + columns - 1) / columns;
+        const int size = max(1, min(W / columns, H / rows));
+        const int left = (W - size * columns) / 2;
+        const int top = (H - size * rows) / 2;
+        for (int k = 0; k < n; ++k)
+        {
+            auto &cell = cells[k];
+            cell.rect = {left + size * (k % columns), top + size * (k / columns), size, size};
+            // Текстура пересоздаётся только при изменении размера доски
+            int w = 0, h = 0;
+            if (cell.texture)
+                SDL_QueryTexture(cell.texture, nullptr, nullptr, &w, &h);
+            if (w != size || h != size)
+            {
+                SDL_DestroyTexture(cell.texture);
+                cell.texture = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
+            }
+        }
+        invalidate();
+    }
+
+    // Все доски перерисовываются (новый размер или потерянное содержимое текстур)
+    void invalidate()
+    {
+        for (auto &cell : cells)
+            cell.dirty = true;
+    }
+
+    // Рисует доску в её текстуру: поле, последний шаг, фигуры и итог партии
+    void draw_cell(board_cell &cell)
+    {
+        const int S = cell.rect.w;
+        const Match &match = *cell.match;
+        const auto &mtx = match.get_board();
+        SDL_SetRenderTarget(ren, cell.texture);
+        SDL_RenderClear(ren);
+        SDL_RenderCopy(ren, textures[TEX_BOARD], NULL, NULL);
+
+        const move_pos &step = match.get_last_step();
+        if (step.x != -1)
+        {
+            SDL_SetRenderDrawColor(ren, 255, 215, 0, 0);
+            for (const auto &[i, j] : {make_pair(step.x, step.y), make_pair(step.x2, step.y2)})
+            {
+                SDL_Rect rect{S * (j + 1) / 10, S * (i + 1) / 10, S / 10, S / 10};
+                SDL_RenderDrawRect(ren, &rect);
+            }
+        }
+
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (!mtx[i][j])
+                    continue;
+                // Как в Board::rerender: клетка 1/10 доски, шашка 1/12
+                SDL_Rect rect{S * (j + 1) / 10 + S / 120, S * (i + 1) / 10 + S / 120, S / 12, S / 12};
+                SDL_RenderCopy(ren, textures[texture_of_piece(mtx[i][j])], NULL, &rect);
+            }
+        }
+
+        if (match.get_state() == Match::State::FINISHED)
+        {
+            SDL_Rect res_rect{S / 5, S * 3 / 10, S * 3 / 5, S * 2 / 5};
+            SDL_RenderCopy(ren, textures[texture_of_result(match.get_result())], NULL, &res_rect);
+        }
+        cell.dirty = false;
+    }
+
+    // Перерисовывает изменившиеся доски и собирает кадр из текстур всех досок
+    void rerender()
+    {
+        TIMELINE_ZONE("render");
+        const auto frame_start = chrono::steady_clock::now();
+        {
+            TIMELINE_ZONE("render_boards");
+            for (auto &cell : cells)
+            {
+                if (cell.dirty && cell.texture)
+                    draw_cell(cell);
+            }
+        }
+        SDL_SetRenderTarget(ren, nullptr);
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+        SDL_RenderClear(ren);
+        for (const auto &cell : cells)
+            SDL_RenderCopy(ren, cell.texture, NULL, &cell.rect);
+        perf.draw(ren, W, H);
+        {
+            TIMELINE_ZONE("present");
+            SDL_RenderPresent(ren);
+        }
+        perf.frame_presented(frame_start);
+    }
+
+    // Логирование ошибок в файл log.txt
+    void print_exception(const string &text)
+    {
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << "Error: " << text << ". " << SDL_GetError() << endl;
+    }
+
+    Config *config;
+    match_pool shared;
+    vector<board_cell> cells;
+    Perf_overlay perf;
+
+    int W = 0;
+    int H = 0;
+    SDL_Window *win = nullptr;
+    SDL_Renderer *ren = nullptr;
+
+    // Текстуры TEXTURE_NAMES (тот же пакет текстур, что у Board), индексы - game_texture
+    vector<SDL_Texture *> textures;
+    const string textures_path = project_path + "Textures/";
+};
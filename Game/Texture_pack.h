@@ -0,0 +1,312 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __APPLE__
+    #include <SDL2/SDL.h>
+    #include <SDL2/SDL_image.h>
+#else
+    #include <SDL.h>
+    #include <SDL_image.h>
+#endif
+
+#include "../Engine/Timeline.h"
+
+using namespace std;
+
+// Картинки игры из папки Textures в порядке TEXTURE_NAMES: индексы в векторе текстур Texture_pack::load
+// для доски (Game/Board.h) и окна наблюдения (Game/Spectator.h). Фигуры идут подряд по значению клетки доски
+// (1 - белая шашка, 2 - черная, 3 - белая дамка, 4 - черная), см. texture_of_piece.
+enum game_texture
+{
+    TEX_BOARD,
+    TEX_WHITE_PIECE,
+    TEX_BLACK_PIECE,
+    TEX_WHITE_QUEEN,
+    TEX_BLACK_QUEEN,
+    TEX_BACK,
+    TEX_REPLAY,
+    TEX_WHITE_WINS,
+    TEX_BLACK_WINS,
+    TEX_DRAW
+};
+
+const vector<string> TEXTURE_NAMES = {"board.png",       "piece_white.png", "piece_black.png", "queen_white.png",
+                                      "queen_black.png", "back.png",        "replay.png",      "white_wins.png",
+                                      "black_wins.png",  "draw.png"};
+
+// Текстура фигуры по значению клетки доски (1..4)
+inline int texture_of_piece(const int cell)
+{
+    return TEX_WHITE_PIECE + cell - 1;
+}
+
+// Текстура итога партии: 0 - ничья, 1 - выиграли белые, 2 - выиграли черные
+inline int texture_of_result(const int result)
+{
+    return result == 1 ? TEX_WHITE_WINS : (result == 2 ? TEX_BLACK_WINS : TEX_DRAW);
+}
+
+// Текстуры из PNG картинок с кэшем декодированных пикселей (Game.TexturePack). Файл пакета отображается в память,
+// его пиксели RGBA32 сразу загружаются в текстуры без декодирования PNG. Файл: заголовок pack_header, таблица
+// pack_entry по картинкам, затем пиксели картинок строка за строкой без выравнивания.
+// В заголовке хранится отпечаток содержимого исходных PNG: если картинки изменились, пакета нет или он
+// повреждён, PNG декодируются параллельно (поток на картинку) и пакет пишется заново.
+class Texture_pack
+{
+  public:
+    static const uint32_t MAGIC = 0x58544b43; // "CKTX"
+    static const uint32_t VERSION = 1;
+
+    // Загружает текстуры картинок dir + names[k] в textures[k]. pack_path - файл пакета, пустая строка -
+    // всегда декодировать PNG. false - картинка не загрузилась, error - описание
+    bool load(SDL_Renderer *ren, const string &dir, const vector<string> &names, const string &pack_path,
+              vector<SDL_Texture *> &textures, string &error)
+    {
+        textures.assign(names.size(), nullptr);
+        // PNG читаются всегда: они небольшие и по ним проверяется пакет
+        vector<string> files(names.size());
+        uint64_t fingerprint = 14695981039346656037ull;
+        for (size_t k = 0; k < names.size(); ++k)
+        {
+            ifstream fin(dir + names[k], ios::binary);
+            if (!fin)
+            {
+                error = "can't read " + dir + names[k];
+                return false;
+            }
+            files[k].assign(istreambuf_iterator<char>(fin), istreambuf_iterator<char>());
+            fingerprint = fnv(fnv(fingerprint, names[k].data(), names[k].size() + 1), files[k].data(), files[k].size());
+        }
+        if (!pack_path.empty() && load_pack(ren, pack_path, names.size(), fingerprint, textures))
+        {
+            from_pack = true;
+            return true;
+        }
+        from_pack = false;
+        vector<SDL_Surface *> surfaces = decode(files);
+        bool ok = true;
+        for (size_t k = 0; k < surfaces.size(); ++k)
+        {
+            if (!surfaces[k])
+            {
+                error = "can't decode " + dir + names[k];
+                ok = false;
+                continue;
+            }
+            textures[k] = make_texture(ren, surfaces[k]->w, surfaces[k]->h, surfaces[k]->pixels, surfaces[k]->pitch);
+            if (!textures[k])
+            {
+                error = string("can't create texture: ") + SDL_GetError();
+                ok = false;
+            }
+        }
+        if (ok && !pack_path.empty())
+            save_pack(pack_path, fingerprint, surfaces);
+        for (auto s : surfaces)
+            SDL_FreeSurface(s);
+        return ok;
+    }
+
+    // Текстуры последней загрузки взяты из пакета
+    bool from_pack = false;
+
+  private:
+    struct pack_header
+    {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t count = 0;
+        uint32_t reserved = 0;
+        uint64_t fingerprint = 0;
+        uint64_t size = 0; // размер файла
+    };
+
+    struct pack_entry
+    {
+        uint32_t w = 0, h = 0;
+        uint64_t offset = 0; // смещение пикселей от начала файла
+    };
+    static_assert(sizeof(pack_header) == 32, "pack_header must be 32 bytes");
+    static_assert(sizeof(pack_entry) == 16, "pack_entry must be 16 bytes");
+
+    static uint64_t fnv(uint64_t h, const char *data, const size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            h = (h ^ uint8_t(data[i])) * 1099511628211ull;
+        return h;
+    }
+
+    // Декодирует PNG в поверхности RGBA32, по потоку на картинку. nullptr - картинка не декодировалась
+    static vector<SDL_Surface *> decode(const vector<string> &files)
+    {
+        TIMELINE_ZONE("decode_textures");
+        IMG_Init(IMG_INIT_PNG); // до потоков: библиотека PNG подгружается при первом вызове
+        vector<SDL_Surface *> surfaces(files.size(), nullptr);
+        vector<thread> threads;
+        for (size_t k = 0; k < files.size(); ++k)
+        {
+            threads.emplace_back([&files, &surfaces, k]() {
+                TIMELINE_ZONE("decode_texture");
+                SDL_Surface *s = IMG_Load_RW(SDL_RWFromConstMem(files[k].data(), int(files[k].size())), 1);
+                if (!s)
+                    return;
+                surfaces[k] = SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_RGBA32, 0);
+                SDL_FreeSurface(s);
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+        return surfaces;
+    }
+
+    static SDL_Texture *make_texture(SDL_Renderer *ren, const int w, const int h, const void *pixels, const int pitch)
+    {
+        SDL_Texture *tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, w, h);
+        if (!tex)
+            return nullptr;
+        SDL_UpdateTexture(tex, NULL, pixels, pitch);
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        return tex;
+    }
+
+    bool load_pack(SDL_Renderer *ren, const string &path, const size_t count, const uint64_t fingerprint,
+                   vector<SDL_Texture *> &textures)
+    {
+        TIMELINE_ZONE("load_texture_pack");
+        size_t size = 0;
+        if (!map_file(path, size))
+            return false;
+        const pack_header *header = reinterpret_cast<const pack_header *>(data);
+        const pack_entry *entries = reinterpret_cast<const pack_entry *>(data + sizeof(pack_header));
+        bool ok = size >= sizeof(pack_header) && header->magic == MAGIC && header->version == VERSION &&
+                  header->count == count && header->fingerprint == fingerprint && header->size == size &&
+                  size >= sizeof(pack_header) + count * sizeof(pack_entry);
+        for (size_t k = 0; ok && k < count; ++k)
+            ok = entries[k].offset + uint64_t(entries[k].w) * entries[k].h * 4 <= size;
+        for (size_t k = 0; ok && k < count; ++k)
+        {
+            textures[k] = make_texture(ren, int(entries[k].w), int(entries[k].h), data + entries[k].offset,
+                                       int(entries[k].w * 4));
+            ok = textures[k] != nullptr;
+        }
+        unmap_file(size);
+        if (!ok)
+        {
+            for (auto &tex : textures)
+            {
+                if (tex)
+                    SDL_DestroyTexture(tex);
+                tex = nullptr;
+            }
+        }
+        return ok;
+    }
+
+    // Пишет пакет во временный файл и переименовывает, чтобы другой запуск не прочитал недописанный пакет
+    static void save_pack(const string &path, const uint64_t fingerprint, const vector<SDL_Surface *> &surfaces)
+    {
+        TIMELINE_ZONE("save_texture_pack");
+        pack_header header;
+        header.count = uint32_t(surfaces.size());
+        header.fingerprint = fingerprint;
+        vector<pack_entry> entries(surfaces.size());
+        uint64_t offset = sizeof(pack_header) + surfaces.size() * sizeof(pack_entry);
+        for (size_t k = 0; k < surfaces.size(); ++k)
+        {
+            entries[k].w = uint32_t(surfaces[k]->w);
+            entries[k].h = uint32_t(surfaces[k]->h);
+            entries[k].offset = offset;
+            offset += uint64_t(entries[k].w) * entries[k].h * 4;
+        }
+        header.size = offset;
+        const string tmp_path = path + ".tmp";
+        ofstream fout(tmp_path, ios::binary | ios::trunc);
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        fout.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(pack_entry));
+        for (const auto s : surfaces)
+        {
+            for (int row = 0; row < s->h; ++row)
+                fout.write(static_cast<const char *>(s->pixels) + size_t(row) * s->pitch, size_t(s->w) * 4);
+        }
+        fout.close();
+        remove(path.c_str());
+        if (!fout || rename(tmp_path.c_str(), path.c_str()) != 0)
+            remove(tmp_path.c_str());
+    }
+
+#ifdef _WIN32
+    bool map_file(const string &path, size_t &size)
+    {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER file_size;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+        {
+            size = size_t(file_size.QuadPart);
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        }
+        if (mapping)
+        {
+            data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size));
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return data != nullptr;
+    }
+
+    void unmap_file(const size_t)
+    {
+        if (data)
+            UnmapViewOfFile(data);
+        data = nullptr;
+    }
+#else
+    bool map_file(const string &path, size_t &size)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            size = size_t(st.st_size);
+            void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+                data = static_cast<const char *>(p);
+        }
+        close(fd);
+        return data != nullptr;
+    }
+
+    void unmap_file(const size_t size)
+    {
+        if (data)
+            munmap(const_cast<char *>(data), size);
+        data = nullptr;
+    }
+#endif
+
+  private:
+    const char *data = nullptr; // отображённый пакет (только во время load_pack)
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <stdint.h>
+
+using namespace std;
+
+// Гистограмма задержек в микросекундах с логарифмическими корзинами (4 корзины на удвоение, погрешность
+// процентилей не больше 19%). Запись без блокировок, можно вызывать из нескольких потоков.
+class Histogram
+{
+  public:
+    static const int BUCKETS = 128;
+
+    void add(const double us)
+    {
+        int idx = us <= 1 ? 0 : min(BUCKETS - 1, int(log2(us) * 4) + 1);
+        counts[idx].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(1, memory_order_relaxed);
+    }
+
+    // Процентиль p (0..100): верхняя граница корзины, в которую он попал
+    double percentile(const double p) const
+    {
+        uint64_t n = count();
+        if (!n)
+            return 0;
+        uint64_t need = uint64_t(ceil(n * p / 100)), sum = 0;
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            sum += counts[i].load(memory_order_relaxed);
+            if (sum >= need && sum)
+                return i == 0 ? 1 : exp2(i / 4.0);
+        }
+        return exp2((BUCKETS - 1) / 4.0);
+    }
+
+    uint64_t count() const
+    {
+        return total.load(memory_order_relaxed);
+    }
+
+    void clear()
+    {
+        for (auto &c : counts)
+            c.store(0, memory_order_relaxed);
+        total.store(0, memory_order_relaxed);
+    }
+
+  private:
+    atomic<uint64_t> counts[BUCKETS] = {};
+    atomic<uint64_t> total{0};
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+
+using namespace std;
+
+// Бинарный формат базы задач (Tools/puzzles.cpp). Файл: заголовок puzzle_header, затем записи puzzle_record
+// фиксированного размера. Позиция кодируется масками тёмных клеток, как в Record.h (бит i * 4 + j / 2).
+
+const uint32_t PUZZLE_MAGIC = 0x5a504b43; // "CKPZ"
+const uint32_t PUZZLE_VERSION = 1;
+const int PUZZLE_MAX_STEPS = 16; // шагов решения в записи
+
+struct puzzle_header
+{
+    uint32_t magic = PUZZLE_MAGIC;
+    uint32_t version = PUZZLE_VERSION;
+    uint32_t record_size = 0;
+    uint32_t reserved = 0;
+};
+
+// Задача: ходящая сторона выигрывает материал единственной комбинацией
+struct puzzle_record
+{
+    uint32_t white;    // маска белых фигур (шашки и дамки)
+    uint32_t black;    // маска черных фигур (шашки и дамки)
+    uint32_t kings;    // маска дамок обоих цветов
+    float score;       // оценка решения глубоким поиском с точки зрения ходящего
+    float second;      // оценка второго по силе первого хода
+    uint32_t game_id;  // номер партии источника
+    uint16_t ply;      // номер хода в партии
+    uint8_t side;      // кто ходит: 0 - белые, 1 - черные
+    uint8_t gain;      // выигрыш фигур после решения и лучшего ответа
+    uint8_t turns;     // ходов решающей стороны
+    uint8_t steps;     // шагов решения (ходы обеих сторон, серия взятий - несколько шагов)
+    uint16_t reserved;
+    uint8_t solution[PUZZLE_MAX_STEPS][2]; // шаги решения: номера тёмных клеток откуда и куда
+};
+static_assert(sizeof(puzzle_header) == 16, "puzzle_header must be 16 bytes");
+static_assert(sizeof(puzzle_record) == 64, "puzzle_record must be 64 bytes");
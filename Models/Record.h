@@ -0,0 +1,95 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "Move.h"
+
+using namespace std;
+
+// Бинарный формат позиций для обучающих данных (self-play).
+// Файл: заголовок record_header, затем массив записей position_record фиксированного размера,
+// поэтому файл можно дописывать потоково и отображать в память как массив.
+// Тёмные клетки доски кодируются битами 32-битной маски: бит (i * 4 + j / 2) соответствует клетке mtx[i][j].
+// Версия 2: score - целая оценка Engine/Score.h (в версии 1 было отношение материала), файлы версии 1
+// не читаются, их нужно пересоздать Tools/selfplay.cpp.
+
+const uint32_t RECORD_MAGIC = 0x52444b43; // "CKDR"
+const uint32_t RECORD_VERSION = 2;
+
+struct record_header
+{
+    uint32_t magic = RECORD_MAGIC;
+    uint32_t version = RECORD_VERSION;
+    uint32_t record_size = 0;
+    uint32_t reserved = 0;
+};
+
+// Одна позиция партии.
+struct position_record
+{
+    uint32_t white;    // маска белых фигур (шашки и дамки)
+    uint32_t black;    // маска черных фигур (шашки и дамки)
+    uint32_t kings;    // маска дамок обоих цветов
+    float score;       // оценка поиска с точки зрения ходящей стороны (целая, Engine/Score.h)
+    uint32_t game_id;  // номер партии
+    uint16_t ply;      // номер хода в партии
+    uint16_t game_len; // количество записей партии (для проверки целостности при дозаписи)
+    uint8_t side;      // кто ходит: 0 - белые, 1 - черные
+    int8_t result;     // итог партии: 0 - ничья, 1 - победа белых, 2 - победа черных
+    uint8_t from, to;  // лучший ход (первый шаг серии) в виде номеров тёмных клеток
+};
+static_assert(sizeof(record_header) == 16, "record_header must be 16 bytes");
+static_assert(sizeof(position_record) == 28, "position_record must be 28 bytes");
+
+// Номер тёмной клетки по координатам
+inline uint8_t cell_index(const POS_T i, const POS_T j)
+{
+    return uint8_t(i * 4 + j / 2);
+}
+
+// Координаты клетки по номеру тёмной клетки
+inline pair<POS_T, POS_T> cell_coords(const uint8_t idx)
+{
+    POS_T i = idx / 4;
+    POS_T j = (idx % 4) * 2 + (i % 2 == 0);
+    return {i, j};
+}
+
+// Упаковывает матрицу доски в маски записи
+inline void pack_board(const vector<vector<POS_T>> &mtx, position_record &rec)
+{
+    rec.white = rec.black = rec.kings = 0;
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        for (POS_T j = (i % 2 == 0); j < 8; j += 2)
+        {
+            if (!mtx[i][j])
+                continue;
+            uint32_t bit = uint32_t(1) << cell_index(i, j);
+            if (mtx[i][j] % 2)
+                rec.white |= bit;
+            else
+                rec.black |= bit;
+            if (mtx[i][j] > 2)
+                rec.kings |= bit;
+        }
+    }
+}
+
+// Восстанавливает матрицу доски из масок записи
+inline vector<vector<POS_T>> unpack_board(const position_record &rec)
+{
+    vector<vector<POS_T>> mtx(8, vector<POS_T>(8, 0));
+    for (uint8_t idx = 0; idx < 32; ++idx)
+    {
+        uint32_t bit = uint32_t(1) << idx;
+        auto [i, j] = cell_coords(idx);
+        if (rec.white & bit)
+            mtx[i][j] = 1;
+        else if (rec.black & bit)
+            mtx[i][j] = 2;
+        if (mtx[i][j] && (rec.kings & bit))
+            mtx[i][j] += 2;
+    }
+    return mtx;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Thread_pool.h"
+
+using namespace std;
+
+// Общая часть пакетных утилит (Tools/Evaluate.h, Tools/Puzzles.h): пул потоков раздела section (Threads), Logic
+// каждого потока пула и окно упорядочивания. Элементы входа отправляются в пул порциями по CHUNK: свободный поток
+// берёт следующую порцию, поэтому долгие позиции не задерживают остальные потоки. Результаты выводятся в порядке
+// входа: основной поток ждёт самую старую порцию окна, пишет её и читает на её место новую. В окне не больше
+// BatchPositions элементов, от этого зависит память.
+// Stats - счётчики порции (узлы и т.п., с оператором +=): поток пула пишет только в счётчики своей порции,
+// основной поток складывает их при выводе, поэтому общих атомарных переменных нет.
+template <class Item, class Stats> class Batch_runner
+{
+  public:
+    static constexpr size_t CHUNK = 16;
+    static constexpr int PROGRESS_MS = 250;
+
+    Batch_runner(Config *config, const string &section) : pool(unsigned(int((*config)(section, "Threads"))))
+    {
+        const size_t batch_positions = max(1, int((*config)(section, "BatchPositions")));
+        chunk = min(CHUNK, batch_positions);
+        slots.resize((batch_positions + chunk - 1) / chunk);
+        for (auto &s : slots)
+            s.items.resize(chunk);
+        for (unsigned i = 0; i < pool.size(); ++i)
+            logics.emplace_back(new Logic(config));
+    }
+
+    unsigned threads() const
+    {
+        return pool.size();
+    }
+
+    // Обрабатывает вход до конца. read(item) - следующий элемент (false - вход кончился), process(item, logic, stats)
+    // выполняется в потоке пула, write(item) - в вызывающем потоке в порядке входа. progress(done, total) -
+    // не чаще PROGRESS_MS и в конце run; счётчики done и total накапливаются между вызовами run
+    template <class Read, class Process, class Write, class Progress>
+    void run(Read read, Process process, Write write, Progress progress)
+    {
+        size_t head = 0, in_flight = 0;
+        bool eof = false;
+        while (true)
+        {
+            while (!eof && in_flight < slots.size())
+            {
+                slot &s = slots[(head + in_flight) % slots.size()];
+                s.size = 0;
+                while (s.size < chunk && read(s.items[s.size]))
+                    ++s.size;
+                if (s.size < chunk)
+                    eof = true;
+                if (s.size == 0)
+                    break;
+                s.stats = Stats();
+                s.ready = false;
+                ++in_flight;
+                pool.submit([this, &s, &process]() {
+                    Logic &logic = *logics[Thread_pool::worker_id()];
+                    for (size_t k = 0; k < s.size; ++k)
+                        process(s.items[k], logic, s.stats);
+                    {
+                        lock_guard<mutex> lock(ready_mtx);
+                        s.ready = true;
+                    }
+                    ready_cv.notify_one();
+                });
+            }
+            if (in_flight == 0)
+            {
+                progress(done, total);
+                break;
+            }
+            slot &s = slots[head];
+            {
+                unique_lock<mutex> lock(ready_mtx);
+                ready_cv.wait(lock, [&s]() { return s.ready; });
+            }
+            for (size_t k = 0; k < s.size; ++k)
+                write(s.items[k]);
+            done += s.size;
+            total += s.stats;
+            const auto now = chrono::steady_clock::now();
+            if (now - last_progress >= chrono::milliseconds(PROGRESS_MS))
+            {
+                last_progress = now;
+                progress(done, total);
+            }
+            head = (head + 1) % slots.size();
+            --in_flight;
+        }
+    }
+
+  private:
+    struct alignas(64) slot
+    {
+        vector<Item> items;
+        size_t size = 0;
+        Stats stats;
+        bool ready = false; // под ready_mtx
+    };
+
+    Thread_pool pool;
+    vector<unique_ptr<Logic>> logics; // Logic каждого потока пула
+    vector<slot> slots;               // окно порций, кольцевой буфер
+    size_t chunk = CHUNK;
+    mutex ready_mtx;
+    condition_variable ready_cv;
+    size_t done = 0;
+    Stats total;
+    chrono::steady_clock::time_point last_progress;
+};
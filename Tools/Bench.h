@@ -0,0 +1,347 @@
+#pragma once
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Perf_counters.h"
+
+// Микробенчмарк горячих функций бота на фиксированном наборе позиций.
+// Бот создаётся с NoRandom = true и без постоянного кэша, поэтому сумма узлов поиска ("bench signature")
+// одинакова при каждом запуске и меняется только при изменении поиска или генерации ходов.
+// С Bench.PerfCounters под строками find_turns, make_turn, уровней и уровней силы печатаются аппаратные
+// счётчики (Engine/Perf_counters.h): IPC, такты и промахи L1d, LLC и предсказания переходов на операцию или узел.
+class Bench
+{
+  public:
+    Bench(Config *config) : config(config)
+    {
+        config->set("Bot", "NoRandom", true);
+        config->set("Bot", "CacheFile", ""); // каждый поиск должен выполняться заново
+        config->set("Bot", "SolverNodes", 0);
+        config->set("Bot", "Engine", "AlphaBeta");
+    }
+
+    int run()
+    {
+        const int board_size = (*config)("Bench", "BoardSize");
+        if (board_size == 10)
+            return run_variant<Logic_10>();
+        return run_variant<Logic>();
+    }
+
+  private:
+    // Замеры на доске геометрии L::geometry
+    template <class L> int run_variant()
+    {
+        const int positions_count = (*config)("Bench", "Positions");
+        const int max_level = (*config)("Bench", "MaxLevel");
+        const int iterations = (*config)("Bench", "Iterations");
+        L logic(config);
+        make_positions(logic, positions_count);
+        cout << "Bench: " << positions.size() << " positions, board " << L::geometry::SIZE << "x" << L::geometry::SIZE
+             << ", scoring " << string((*config)("Bot", "BotScoringType")) << ", optimization "
+             << string((*config)("Bot", "Optimization")) << endl;
+        if ((*config)("Bench", "PerfCounters"))
+        {
+            counters.reset(new Perf_counters);
+            if (!counters->available())
+                cout << "Perf counters unavailable: " << counters->error() << endl;
+        }
+
+        // find_turns для всех фигур ходящего
+        size_t ops = 0;
+        auto start = chrono::steady_clock::now();
+        counters_start();
+        for (int it = 0; it < iterations; ++it)
+        {
+            for (auto &[mtx, color] : positions)
+            {
+                logic.find_turns(color, mtx);
+                sink += logic.turns.size();
+                ++ops;
+            }
+        }
+        auto sample = counters_stop();
+        report("find_turns", start, ops);
+        print_counters(sample, ops, "op");
+
+        // make_turn для всех ходов позиции
+        ops = 0;
+        vector<vector<move_pos>> all_turns;
+        for (auto &[mtx, color] : positions)
+        {
+            logic.find_turns(color, mtx);
+            all_turns.push_back(logic.turns);
+        }
+        start = chrono::steady_clock::now();
+        counters_start();
+        for (int it = 0; it < iterations; ++it)
+        {
+            for (size_t p = 0; p < positions.size(); ++p)
+            {
+                for (auto &turn : all_turns[p])
+                {
+                    sink += logic.make_turn(positions[p].first, turn)[turn.x2][turn.y2];
+                    ++ops;
+                }
+            }
+        }
+        sample = counters_stop();
+        report("make_turn", start, ops);
+        print_counters(sample, ops, "op");
+
+        // calc_score (для NNUE аккумулятор корня готовит поиск нулевой глубины)
+        ops = 0;
+        chrono::steady_clock::duration total{};
+        for (auto &[mtx, color] : positions)
+        {
+            logic.Max_depth = 0;
+            logic.find_best_turns(mtx, color);
+            start = chrono::steady_clock::now();
+            for (int it = 0; it < iterations; ++it)
+            {
+                sink += logic.calc_score(mtx, color);
+                ++ops;
+            }
+            total += chrono::steady_clock::now() - start;
+        }
+        cout << left << setw(14) << "calc_score" << right << fixed << setprecision(1)
+             << chrono::duration<double, nano>(total).count() / ops << " ns/op" << endl;
+
+        // Пакетные генерация ходов и оценка (Engine/Batch.h) против find_turns + calc_score по одной позиции
+        if constexpr (L::geometry::SIZE == 8)
+        {
+            run_batch(logic, iterations);
+            run_nnue(logic);
+        }
+
+        // Полный поиск на разных уровнях
+        size_t signature = 0;
+        for (int level = 0; level <= max_level; ++level)
+        {
+            logic.Max_depth = level;
+            size_t nodes = 0;
+            Perf_counters::sample searches;
+            start = chrono::steady_clock::now();
+            for (auto &[mtx, color] : positions)
+            {
+                counters_start();
+                logic.find_best_turns(mtx, color);
+                searches += counters_stop();
+                nodes += logic.nodes;
+            }
+            double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "level " << setw(2) << level << ": nodes " << setw(12) << nodes << ", " << setw(10)
+                 << setprecision(1) << sec * 1000 << " ms, " << setw(12) << setprecision(0)
+                 << (sec > 0 ? nodes / sec : 0) << " nodes/s, " << setw(8) << setprecision(1)
+                 << (nodes ? sec * 1e9 / nodes : 0) << " ns/node" << endl;
+            print_counters(searches, nodes, "node");
+            signature += nodes;
+        }
+
+        // Уровни силы: бюджет узлов на ход, время хода почти не зависит от позиции
+        for (int skill = 1; skill <= MAX_SKILL; ++skill)
+        {
+            size_t nodes = 0;
+            double total_ms = 0, max_ms = 0;
+            Perf_counters::sample searches;
+            for (auto &[mtx, color] : positions)
+            {
+                start = chrono::steady_clock::now();
+                counters_start();
+                logic.find_skill_turns(mtx, color, skill);
+                searches += counters_stop();
+                double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                nodes += logic.nodes;
+                total_ms += ms;
+                max_ms = max(max_ms, ms);
+            }
+            cout << "skill " << setw(2) << skill << ": nodes " << setw(12) << nodes << ", " << setw(10)
+                 << setprecision(2) << total_ms / positions.size() << " ms/move, max " << setw(8) << max_ms << " ms"
+                 << endl;
+            print_counters(searches, nodes, "node");
+        }
+        cout << "Bench signature: " << signature << endl;
+        return 0;
+    }
+
+    // Пакет из BatchSize позиций (набор повторяется): время на позицию для скалярного пути Logic и для каждого
+    // набора команд пакетного ядра, результаты ядра сверяются с find_turns и calc_score
+    template <class L> void run_batch(L &logic, const int iterations)
+    {
+        const size_t batch_size = max(1, int((*config)("Bench", "BatchSize")));
+        const size_t repeats = max<size_t>(1, size_t(iterations) * positions.size() / batch_size);
+        batch_positions batch;
+        vector<vector<vector<POS_T>>> boards;
+        for (size_t k = 0; k < batch_size; ++k)
+        {
+            const auto &[mtx, color] = positions[k % positions.size()];
+            batch.push(mtx, color);
+            boards.push_back(mtx);
+        }
+
+        batch_results expected;
+        expected.turns.resize(batch_size);
+        expected.beats.resize(batch_size);
+        expected.score.resize(batch_size);
+        auto start = chrono::steady_clock::now();
+        for (size_t it = 0; it < repeats; ++it)
+        {
+            for (size_t k = 0; k < batch_size; ++k)
+            {
+                const bool color = batch.side[k];
+                logic.find_turns(color, boards[k]);
+                expected.turns[k] = uint32_t(logic.turns.size());
+                expected.beats[k] = logic.have_beats;
+                expected.score[k] = logic.evaluate(boards[k], color);
+            }
+        }
+        report("batch/logic", start, repeats * batch_size);
+
+        for (const auto k : {Batch::SCALAR, Batch::SSE2, Batch::AVX2})
+        {
+            if (!Batch::supported(k))
+                continue;
+            batch_results res;
+            start = chrono::steady_clock::now();
+            for (size_t it = 0; it < repeats; ++it)
+            {
+                logic.evaluate_batch(batch, res, k);
+                sink += res.turns[it % batch_size];
+            }
+            const double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            size_t mismatches = 0;
+            for (size_t p = 0; p < batch_size; ++p)
+                mismatches += res.turns[p] != expected.turns[p] || res.beats[p] != expected.beats[p] ||
+                              res.score[p] != expected.score[p];
+            cout << left << setw(14) << (string("batch/") + Batch::name(k)) << right << fixed << setprecision(1)
+                 << ns / (repeats * batch_size) << " ns/op";
+            if (mismatches)
+                cout << ", " << mismatches << " positions differ from find_turns/calc_score";
+            cout << endl;
+        }
+    }
+
+    // Инкрементальное обновление аккумулятора нейросети против полного пересчёта refresh: из каждой позиции набора
+    // случайная партия, после каждого шага (и каждого взятия серии) аккумулятор update сверяется с refresh
+    // новой позиции. Сеть - Bot.NnueFile, если он загружается, иначе случайная (Tools/nnueexport.cpp)
+    template <class L> void run_nnue(L &logic)
+    {
+        Nnue net;
+        const string nnue_path = project_path + string((*config)("Bot", "NnueFile"));
+        const bool loaded = net.load(nnue_path);
+        if (!loaded)
+            net.make_random(1);
+        mt19937 eng(2024);
+        size_t steps = 0, mismatches = 0;
+        chrono::steady_clock::duration update_time{}, refresh_time{};
+        for (auto [mtx, color] : positions)
+        {
+            Nnue::accumulator acc, next, full;
+            net.refresh(acc, mtx);
+            for (int plies = 0; plies < 40; ++plies)
+            {
+                logic.find_turns(color, mtx);
+                if (logic.turns.empty())
+                    break;
+                move_pos turn = logic.turns[eng() % logic.turns.size()];
+                while (true)
+                {
+                    auto start = chrono::steady_clock::now();
+                    net.update(acc, next, mtx, turn);
+                    update_time += chrono::steady_clock::now() - start;
+                    mtx = logic.make_turn(mtx, turn);
+                    start = chrono::steady_clock::now();
+                    net.refresh(full, mtx);
+                    refresh_time += chrono::steady_clock::now() - start;
+                    mismatches += !equal(begin(next.v), end(next.v), begin(full.v)) || next.white != full.white ||
+                                  next.black != full.black || net.evaluate(next) != net.evaluate(full);
+                    ++steps;
+                    acc = full;
+                    if (turn.xb == -1)
+                        break;
+                    logic.find_turns(turn.x2, turn.y2, mtx);
+                    if (!logic.have_beats)
+                        break;
+                    turn = logic.turns[eng() % logic.turns.size()];
+                }
+                color = !color;
+            }
+        }
+        cout << left << setw(14) << "nnue/update" << right << fixed << setprecision(1)
+             << chrono::duration<double, nano>(update_time).count() / max<size_t>(1, steps) << " ns/op" << endl;
+        cout << left << setw(14) << "nnue/refresh" << right << fixed << setprecision(1)
+             << chrono::duration<double, nano>(refresh_time).count() / max<size_t>(1, steps) << " ns/op, "
+             << steps << " steps, " << mismatches << " mismatches, net " << (loaded ? nnue_path : "random") << endl;
+    }
+
+    // Набор позиций разных стадий партии: детерминированные случайные партии из начальной позиции
+    template <class L> void make_positions(L &logic, const int count)
+    {
+        mt19937 eng(2024);
+        auto mtx = L::start_mtx();
+        bool color = 0;
+        int plies = 0;
+        positions.emplace_back(mtx, color);
+        while (int(positions.size()) < count)
+        {
+            logic.find_turns(color, mtx);
+            if (logic.turns.empty() || plies == 60)
+            {
+                mtx = L::start_mtx();
+                color = 0;
+                plies = 0;
+                continue;
+            }
+            move_pos turn = logic.turns[eng() % logic.turns.size()];
+            mtx = logic.make_turn(mtx, turn);
+            while (turn.xb != -1)
+            {
+                logic.find_turns(turn.x2, turn.y2, mtx);
+                if (!logic.have_beats)
+                    break;
+                turn = logic.turns[eng() % logic.turns.size()];
+                mtx = logic.make_turn(mtx, turn);
+            }
+            color = !color;
+            // Каждая шестая позиция партии попадает в набор
+            if (++plies % 6 == 0)
+                positions.emplace_back(mtx, color);
+        }
+    }
+
+    void report(const string &name, const chrono::steady_clock::time_point start, const size_t ops) const
+    {
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        cout << left << setw(14) << name << right << fixed << setprecision(1) << ns / ops << " ns/op" << endl;
+    }
+
+    // Аппаратные счётчики замера (Bench.PerfCounters); без счётчиков замер пустой
+    void counters_start()
+    {
+        if (counters)
+            counters->start();
+    }
+
+    Perf_counters::sample counters_stop()
+    {
+        return counters ? counters->stop() : Perf_counters::sample();
+    }
+
+    // Строка счётчиков под строкой замера: на единицу работы units (операцию или узел)
+    void print_counters(const Perf_counters::sample &sample, const size_t units, const string &unit) const
+    {
+        if (!sample.empty())
+            cout << setw(14) << "" << sample.summary(units, unit) << endl;
+    }
+
+  private:
+    Config *config;
+    vector<pair<vector<vector<POS_T>>, bool>> positions;
+    unique_ptr<Perf_counters> counters; // Bench.PerfCounters
+    volatile double sink = 0; // не даёт компилятору выбросить измеряемые вызовы
+};
@@ -0,0 +1,301 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include "../Engine/Config.h"
+#include "../Models/Project_path.h"
+#include "Socket.h"
+
+// Координатор распределённого турнира (Tools/cluster.cpp coordinator): раздаёт партии движков A и B
+// исполнителям (Tools/Worker.h, протокол описан там) и собирает результаты.
+// Партии идут парами: партии 2k и 2k + 1 начинаются одним случайным дебютом, A играет белыми в чётной.
+// Каждый результат сразу дописывается строкой JSON в файл Checkpoint, первая строка файла - параметры турнира.
+// При перезапуске с теми же параметрами сыгранные партии берутся из файла, раздаются только остальные.
+// Партии отключившегося исполнителя возвращаются в очередь.
+class Coordinator
+{
+  public:
+    Coordinator(Config *config) : config(config)
+    {
+    }
+
+    int run()
+    {
+        const string host = (*config)("Cluster", "Host");
+        const int port = (*config)("Cluster", "Port");
+        const string checkpoint_path = project_path + string((*config)("Cluster", "Checkpoint"));
+        games = (*config)("Cluster", "Games");
+        params = tournament_params();
+        if (int(params["Level"]) < 0 && size_t(params["Nodes"]) == 0 && unsigned(params["TimeMS"]) == 0)
+        {
+            cerr << "Coordinator: Level < 0 needs a Nodes or TimeMS limit" << endl;
+            return 1;
+        }
+
+        if (!load_checkpoint(checkpoint_path))
+            return 1;
+        for (uint32_t g = 0; g < games; ++g)
+        {
+            if (!results.count(g))
+                pending.push_back(g);
+        }
+        cout << "Coordinator: " << results.size() << " of " << games << " games already in " << checkpoint_path
+             << endl;
+        if (pending.empty())
+        {
+            print_summary();
+            return 0;
+        }
+
+        if (!socket_init())
+        {
+            cerr << "Can't initialize sockets" << endl;
+            return 1;
+        }
+        socket_t listener = socket_listen(host, port);
+        if (listener == BAD_SOCKET)
+        {
+            cerr << "Can't listen on " << host << ":" << port << endl;
+            return 1;
+        }
+        start = chrono::steady_clock::now();
+        vector<poll_fd> fds;
+        while (!pending.empty() || !in_flight.empty())
+        {
+            fds.assign(1, poll_fd{});
+            fds[0].fd = listener;
+            fds[0].events = POLLIN;
+            for (auto &[fd, w] : workers)
+            {
+                poll_fd p = {};
+                p.fd = fd;
+                p.events = POLLIN;
+                fds.push_back(p);
+            }
+            if (socket_poll(fds, 1000) < 0)
+                continue;
+            if (fds[0].revents & POLLIN)
+            {
+                socket_t fd = socket_accept(listener);
+                if (fd != BAD_SOCKET)
+                    workers[fd];
+            }
+            for (size_t k = 1; k < fds.size(); ++k)
+            {
+                if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+                socket_t fd = fds[k].fd;
+                vector<string> lines;
+                bool alive = workers[fd].reader.read(fd, lines);
+                for (size_t i = 0; alive && i < lines.size(); ++i)
+                    alive = handle(fd, lines[i]);
+                if (!alive)
+                    drop_worker(fd);
+            }
+        }
+        // Остальным исполнителям больше нечего делать
+        for (auto &[fd, w] : workers)
+        {
+            socket_send(fd, "done\n");
+            socket_close(fd);
+        }
+        socket_close(listener);
+        cout << endl;
+        print_summary();
+        return 0;
+    }
+
+  private:
+    struct worker_state
+    {
+        line_reader reader;
+        set<uint32_t> games; // выданные и ещё не сыгранные партии
+    };
+
+    // Параметры, от которых зависят партии: при их изменении старый файл результатов не подходит
+    json tournament_params() const
+    {
+        json res;
+        for (const string name : {"EngineA", "EngineB", "Level", "Nodes", "TimeMS", "OpeningTurns", "Seed"})
+            res[name] = (*config)("Cluster", name);
+        res["MaxNumTurns"] = (*config)("Game", "MaxNumTurns");
+        return res;
+    }
+
+    bool load_checkpoint(const string &path)
+    {
+        ifstream fin(path);
+        string line;
+        if (fin && getline(fin, line) && !line.empty())
+        {
+            json header = json::parse(line, nullptr, false);
+            if (header.is_discarded() || header["tournament"] != params)
+            {
+                cerr << "Coordinator: " << path << " belongs to another tournament" << endl;
+                return false;
+            }
+            while (getline(fin, line))
+            {
+                // Недописанная последняя строка пропускается, партия будет сыграна заново
+                json res = json::parse(line, nullptr, false);
+                if (res.is_discarded() || !res.contains("game"))
+                    continue;
+                uint32_t g = res["game"];
+                if (g < games && !results.count(g))
+                    add_result(res);
+            }
+            fin.close();
+            checkpoint.open(path, ios::app);
+        }
+        else
+        {
+            fin.close();
+            checkpoint.open(path, ios::trunc);
+            json header;
+            header["tournament"] = params;
+            checkpoint << header.dump() << endl;
+        }
+        return bool(checkpoint);
+    }
+
+    bool handle(const socket_t fd, const string &line)
+    {
+        if (line == "ready")
+        {
+            if (pending.empty())
+                return socket_send(fd, in_flight.empty() ? "done\n" : "wait\n");
+            uint32_t g = pending.front();
+            pending.pop_front();
+            workers[fd].games.insert(g);
+            in_flight.insert(g);
+            return socket_send(fd, "game " + assignment(g).dump() + "\n");
+        }
+        if (line.rfind("result ", 0) == 0)
+        {
+            json res = json::parse(line.substr(7), nullptr, false);
+            if (res.is_discarded() || !res.contains("game"))
+                return false;
+            uint32_t g = res["game"];
+            if (!workers[fd].games.count(g))
+                return false;
+            workers[fd].games.erase(g);
+            in_flight.erase(g);
+            checkpoint << res.dump() << endl;
+            add_result(res);
+            print_progress();
+            return true;
+        }
+        return false;
+    }
+
+    void drop_worker(const socket_t fd)
+    {
+        for (uint32_t g : workers[fd].games)
+        {
+            in_flight.erase(g);
+            pending.push_front(g);
+        }
+        workers.erase(fd);
+        socket_close(fd);
+    }
+
+    // Задание партии g (формат описан в Worker.h)
+    json assignment(const uint32_t g) const
+    {
+        const bool a_white = g % 2 == 0;
+        json engines[2];
+        for (int e = 0; e < 2; ++e)
+        {
+            engines[e]["name"] = e ? "B" : "A";
+            engines[e]["options"] = params[e ? "EngineB" : "EngineA"];
+            engines[e]["level"] = params["Level"];
+            engines[e]["nodes"] = params["Nodes"];
+            engines[e]["time_ms"] = params["TimeMS"];
+        }
+        json task;
+        task["game"] = g;
+        task["seed"] = unsigned(params["Seed"]) + g / 2;
+        task["opening_turns"] = params["OpeningTurns"];
+        task["max_turns"] = params["MaxNumTurns"];
+        task["white"] = engines[a_white ? 0 : 1];
+        task["black"] = engines[a_white ? 1 : 0];
+        return task;
+    }
+
+    // Учитывает результат партии с точки зрения движка A
+    void add_result(const json &res)
+    {
+        uint32_t g = res["game"];
+        int result = res["result"];
+        results[g] = result;
+        const bool a_white = g % 2 == 0;
+        if (result == 0)
+            ++draws;
+        else if ((result == 1) == a_white)
+            ++wins;
+        else
+            ++losses;
+        if (res.contains("ms"))
+            total_ms += size_t(res["ms"]);
+    }
+
+    // Разница рейтингов Эло A - B и половина 95% доверительного интервала
+    void elo(double &diff, double &margin) const
+    {
+        double n = wins + draws + losses;
+        diff = margin = 0;
+        if (n == 0)
+            return;
+        double score = (wins + draws * 0.5) / n;
+        double var = (wins * pow(1 - score, 2) + draws * pow(0.5 - score, 2) + losses * pow(score, 2)) / n;
+        double sigma = sqrt(var / n);
+        auto to_elo = [](double s) {
+            s = min(max(s, 1e-6), 1 - 1e-6);
+            return -400 * log10(1 / s - 1);
+        };
+        diff = to_elo(score);
+        margin = (to_elo(score + 1.96 * sigma) - to_elo(score - 1.96 * sigma)) / 2;
+    }
+
+    void print_progress() const
+    {
+        double diff, margin;
+        elo(diff, margin);
+        double minutes = chrono::duration<double>(chrono::steady_clock::now() - start).count() / 60;
+        cout << "\rgames " << results.size() << "/" << games << ", A vs B +" << wins << " =" << draws << " -" << losses
+             << fixed << setprecision(1) << ", elo " << showpos << diff << noshowpos << " +- " << margin << ", "
+             << workers.size() << " connections, " << size_t(minutes > 0 ? results.size() / minutes : 0)
+             << " games/min   " << flush;
+    }
+
+    void print_summary() const
+    {
+        double diff, margin;
+        elo(diff, margin);
+        double n = wins + draws + losses;
+        cout << "A: " << params["EngineA"].dump() << endl << "B: " << params["EngineB"].dump() << endl;
+        cout << "Games " << results.size() << ": A wins " << wins << ", draws " << draws << ", B wins " << losses
+             << fixed << setprecision(1) << ", score " << (n ? (wins + draws * 0.5) / n * 100 : 0) << "%, elo "
+             << showpos << diff << noshowpos << " +- " << margin << ", average game " << (n ? total_ms / n / 1000 : 0.0)
+             << " s" << endl;
+    }
+
+  private:
+    Config *config;
+    uint32_t games = 0;
+    json params;
+    map<uint32_t, int> results;
+    deque<uint32_t> pending;
+    set<uint32_t> in_flight;
+    map<socket_t, worker_state> workers;
+    ofstream checkpoint;
+    size_t wins = 0, draws = 0, losses = 0, total_ms = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+};
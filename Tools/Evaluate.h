@@ -0,0 +1,189 @@
+#pragma once
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Notation.h"
+#include "../Models/Project_path.h"
+#include "../Models/Record.h"
+#include "Batch_runner.h"
+
+// Пакетная оценка позиций для разметки данных. Вход - текст (FEN в строке, пустые строки и строки с #
+// пропускаются) или бинарный файл позиций Models/Record.h (определяется по заголовку). Каждая позиция
+// просчитывается ботом с ограничениями Level и Nodes, результат пишется в том же формате, что и вход:
+// строка "FEN оценка ход узлы" или запись с новыми score, from и to (остальные поля сохраняются).
+// Файл читается потоково, позиции оцениваются в пуле потоков Tools/Batch_runner.h (у каждого потока свой Logic)
+// и записываются в порядке входа; в работе не больше BatchPositions позиций, поэтому память не зависит
+// от размера файла.
+class Evaluate
+{
+  public:
+    Evaluate(Config *config) : config(config)
+    {
+        config->set("Bot", "NoRandom", true); // одинаковая разметка при повторном запуске
+    }
+
+    int run(string in_path = "", string out_path = "")
+    {
+        if (in_path.empty())
+            in_path = project_path + string((*config)("Evaluate", "Input"));
+        if (out_path.empty())
+            out_path = project_path + string((*config)("Evaluate", "Output"));
+        limits.level = (*config)("Evaluate", "Level");
+        limits.nodes = (*config)("Evaluate", "Nodes");
+        if (!limits.bounded())
+        {
+            cerr << "Evaluate: Level < 0 needs a Nodes limit" << endl;
+            return 1;
+        }
+        ifstream fin(in_path, ios::binary);
+        if (!fin)
+        {
+            cerr << "Evaluate: can't open " << in_path << endl;
+            return 1;
+        }
+        record_header header;
+        fin.read(reinterpret_cast<char *>(&header), sizeof(header));
+        const bool binary = fin.gcount() == sizeof(header) && header.magic == RECORD_MAGIC;
+        if (binary && (header.version != RECORD_VERSION || header.record_size != sizeof(position_record)))
+        {
+            cerr << "Evaluate: " << in_path << " has incompatible format" << endl;
+            return 1;
+        }
+        if (!binary)
+        {
+            fin.clear();
+            fin.seekg(0);
+        }
+        ofstream fout(out_path, ios::binary | ios::trunc);
+        if (!fout)
+        {
+            cerr << "Evaluate: can't open " << out_path << endl;
+            return 1;
+        }
+        if (binary)
+            fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        Batch_runner<item, eval_stats> runner(config, "Evaluate");
+        cout << "Evaluate: " << in_path << " (" << (binary ? "binary" : "text") << ") -> " << out_path << ", "
+             << runner.threads() << " threads, level " << limits.level << ", nodes " << limits.nodes << endl;
+
+        auto start = chrono::steady_clock::now();
+        runner.run(
+            [&fin, binary](item &it) {
+                if (binary)
+                {
+                    fin.read(reinterpret_cast<char *>(&it.rec), sizeof(it.rec));
+                    return fin.gcount() == sizeof(it.rec);
+                }
+                while (getline(fin, it.line))
+                {
+                    while (!it.line.empty() && isspace((unsigned char)it.line.back()))
+                        it.line.pop_back();
+                    if (!it.line.empty() && it.line[0] != '#')
+                        return true;
+                }
+                return false;
+            },
+            [this, binary](item &it, Logic &logic, eval_stats &st) {
+                if (binary)
+                    evaluate(logic, st, it.rec);
+                else
+                    evaluate(logic, st, it.line);
+            },
+            [&fout, binary](const item &it) {
+                if (binary)
+                    fout.write(reinterpret_cast<const char *>(&it.rec), sizeof(it.rec));
+                else
+                    fout << it.line << '\n';
+            },
+            [start](const size_t positions, const eval_stats &total) { print_progress(positions, total, start); });
+        fout.close();
+        cout << endl;
+        return 0;
+    }
+
+  private:
+    // Позиция входа: запись бинарного файла или строка FEN (заменяется строкой результата)
+    struct item
+    {
+        position_record rec;
+        string line;
+    };
+
+    struct eval_stats
+    {
+        size_t nodes = 0;
+
+        eval_stats &operator+=(const eval_stats &other)
+        {
+            nodes += other.nodes;
+            return *this;
+        }
+    };
+
+    // Оценка и лучший ход позиции, выполняется в потоке пула. false - у ходящего нет ходов
+    bool search(Logic &logic, eval_stats &st, const vector<vector<POS_T>> &mtx, const bool color, SCORE_T &score,
+                vector<move_pos> &turn)
+    {
+        logic.find_turns(color, mtx);
+        if (logic.turns.empty())
+        {
+            score = loss_in(0); // ходящий проиграл
+            turn.clear();
+            return false;
+        }
+        turn = logic.search(mtx, color, limits);
+        score = logic.last_score;
+        st.nodes += logic.nodes;
+        return true;
+    }
+
+    void evaluate(Logic &logic, eval_stats &st, position_record &rec)
+    {
+        SCORE_T score;
+        vector<move_pos> turn;
+        if (search(logic, st, unpack_board(rec), rec.side, score, turn))
+        {
+            rec.from = cell_index(turn[0].x, turn[0].y);
+            rec.to = cell_index(turn[0].x2, turn[0].y2);
+        }
+        rec.score = float(score);
+    }
+
+    // Строка FEN заменяется строкой результата
+    void evaluate(Logic &logic, eval_stats &st, string &line)
+    {
+        vector<vector<POS_T>> mtx;
+        bool color;
+        if (!from_fen(line, mtx, color))
+        {
+            line += " bad";
+            return;
+        }
+        SCORE_T score;
+        vector<move_pos> turn;
+        const bool has_turn = search(logic, st, mtx, color, score, turn);
+        stringstream ss;
+        ss << line << ' ' << score << ' ' << (has_turn ? turn_to_string(turn) : "-") << ' '
+           << (has_turn ? logic.nodes : 0);
+        line = ss.str();
+    }
+
+    static void print_progress(const size_t positions, const eval_stats &total,
+                               const chrono::steady_clock::time_point start)
+    {
+        const size_t nodes = total.nodes;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "\rpositions " << positions << ", nodes " << nodes << ", " << fixed << setprecision(1) << seconds
+             << " s, " << setprecision(0) << (seconds > 0 ? positions / seconds : 0) << " positions/s, "
+             << (seconds > 0 ? nodes / seconds : 0) << " nodes/s" << flush;
+    }
+
+  private:
+    Config *config;
+    search_limits limits;
+};
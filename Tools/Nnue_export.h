@@ -0,0 +1,89 @@
+#pragma once
+#include <fstream>
+#include <iostream>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Nnue.h"
+#include "../Models/Project_path.h"
+
+// Создание файла весов нейросети (Bot.NnueFile) без обучения: "Material" - сеть по коэффициентам
+// NumberAndPotential из Bot.WeightsFile (Tools/tuner.cpp) или значениям по умолчанию, "Random" - случайные веса
+// для проверки загрузки и инкрементального обновления. Записанный файл загружается обратно, и оценки загруженной
+// сети сравниваются с построенной на позициях случайных партий.
+class Nnue_export
+{
+  public:
+    Nnue_export(Config *config) : config(config)
+    {
+    }
+
+    int run()
+    {
+        const string mode = (*config)("NnueExport", "Mode");
+        const string out_path = project_path + string((*config)("Bot", "NnueFile"));
+        double potential_coef = 0.05, q_coef = 5;
+        Nnue net;
+        if (mode == "Random")
+            net.make_random(unsigned((*config)("NnueExport", "Seed")));
+        else if (mode == "Material")
+        {
+            ifstream fin(project_path + string((*config)("Bot", "WeightsFile")));
+            if (fin)
+            {
+                json weights;
+                fin >> weights;
+                potential_coef = weights["PotentialCoef"];
+                q_coef = weights["QueenCoef"];
+            }
+            net.make_material(potential_coef, q_coef);
+        }
+        else
+        {
+            cerr << "Unknown NnueExport.Mode " << mode << endl;
+            return 1;
+        }
+        if (!net.save(out_path))
+        {
+            cerr << "Can't write " << out_path << endl;
+            return 1;
+        }
+
+        // Проверка записанного файла: та же оценка на позициях случайных партий
+        Nnue loaded;
+        if (!loaded.load(out_path))
+        {
+            cerr << "Can't load written " << out_path << endl;
+            return 1;
+        }
+        config->set("Bot", "BotScoringType", "NumberOnly");
+        Logic logic(config);
+        mt19937 eng(1);
+        size_t checked = 0, mismatches = 0;
+        for (int game = 0; game < 20; ++game)
+        {
+            auto mtx = Logic::start_mtx();
+            for (int turn_num = 0; turn_num < 80; ++turn_num)
+            {
+                logic.find_turns(turn_num % 2, mtx);
+                if (logic.turns.empty())
+                    break;
+                mtx = logic.make_turn(mtx, logic.turns[eng() % logic.turns.size()]);
+                Nnue::accumulator a, b;
+                net.refresh(a, mtx);
+                loaded.refresh(b, mtx);
+                mismatches += net.evaluate(a) != loaded.evaluate(b);
+                ++checked;
+            }
+        }
+        cout << "NNUE " << mode;
+        if (mode == "Material")
+            cout << " (PotentialCoef " << potential_coef << ", QueenCoef " << q_coef << ")";
+        cout << " written to " << out_path << ", " << checked << " positions checked, " << mismatches
+             << " mismatches" << endl;
+        return mismatches ? 1 : 0;
+    }
+
+  private:
+    Config *config;
+};
@@ -0,0 +1,243 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Notation.h"
+
+// Текстовый протокол движка через stdin/stdout (по образцу UCI). Команды:
+//   isready                                   -> readyok
+//   newgame                                   новая партия, начальная позиция
+//   position startpos|fen <FEN> [moves <ход> ...]
+//   setoption <раздел> <настройка> <JSON>     например "setoption Bot BotScoringType \"NumberOnly\""
+//   go [depth N] [nodes N] [movetime MS] [infinite] [ponder]
+//   ponderhit                                 ожидаемый ход сделан, поиск продолжается как обычный
+//   stop                                      остановить поиск и выдать bestmove
+//   quit
+// Во время поиска после каждой глубины выводится
+//   info depth D score S nodes N nps X time MS pv <ходы>
+// и в конце bestmove <ход> [ponder <ход>]. Глубина - уровень бота + 1, оценка - как у Logic::calc_score.
+class Protocol
+{
+  public:
+    Protocol(Config *config) : config(config), logic(config), mtx(Logic::start_mtx())
+    {
+    }
+
+    int run()
+    {
+        print("id name Checkers");
+        print("ready");
+        string line;
+        while (getline(cin, line))
+        {
+            stringstream ss(line);
+            string cmd;
+            ss >> cmd;
+            if (cmd.empty())
+                continue;
+            if (cmd == "quit")
+                break;
+            if (cmd == "isready")
+                print("readyok");
+            else if (cmd == "newgame")
+            {
+                stop_search();
+                logic = Logic(config);
+                mtx = Logic::start_mtx();
+                color = 0;
+            }
+            else if (cmd == "position")
+            {
+                stop_search();
+                set_position(ss);
+            }
+            else if (cmd == "setoption")
+            {
+                stop_search();
+                set_option(ss);
+            }
+            else if (cmd == "go")
+            {
+                stop_search();
+                go(ss);
+            }
+            else if (cmd == "ponderhit")
+            {
+                ponder_hit();
+            }
+            else if (cmd == "stop")
+            {
+                stop_search();
+            }
+            else
+            {
+                print("info string unknown command " + cmd);
+            }
+        }
+        stop_search();
+        return 0;
+    }
+
+  private:
+    void print(const string &text)
+    {
+        lock_guard<mutex> lock(out_mtx);
+        cout << text << endl;
+    }
+
+    void set_position(stringstream &ss)
+    {
+        string error = parse_position(logic, ss, mtx, color);
+        if (!error.empty())
+            print("info string " + error);
+    }
+
+    void set_option(stringstream &ss)
+    {
+        string section, name, value;
+        ss >> section >> name;
+        getline(ss, value);
+        try
+        {
+            config->set(section, name, json::parse(value));
+            logic = Logic(config);
+        }
+        catch (const exception &e)
+        {
+            print(string("info string bad option value: ") + e.what());
+        }
+    }
+
+    void go(stringstream &ss)
+    {
+        search_limits limits;
+        limits.level = (*config)("Bot", string(color ? "Black" : "White") + "BotLevel");
+        unsigned movetime = 0;
+        bool has_depth = false, has_limit = false;
+        infinite = pondering = false;
+        string word;
+        while (ss >> word)
+        {
+            if (word == "depth" && ss >> limits.level)
+            {
+                limits.level = max(limits.level - 1, 0);
+                has_depth = true;
+            }
+            else if (word == "nodes" && ss >> limits.nodes)
+                has_limit = true;
+            else if (word == "movetime" && ss >> movetime)
+                has_limit = true;
+            else if (word == "infinite")
+                infinite = has_limit = true;
+            else if (word == "ponder")
+                pondering = true;
+        }
+        if (has_limit && !has_depth)
+            limits.level = -1;
+
+        stop = false;
+        search_start = chrono::steady_clock::now();
+        searcher = thread(&Protocol::search, this, limits);
+        if (movetime)
+        {
+            this->movetime = movetime;
+            if (!pondering)
+                start_timer();
+        }
+    }
+
+    void search(const search_limits limits)
+    {
+        logic.stop_signal = &stop;
+        logic.collect_pv = true;
+        logic.on_iteration = [this](int level, SCORE_T score, size_t nodes, const vector<move_pos> &pv) {
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - search_start).count();
+            stringstream info;
+            info << "info depth " << level + 1 << " score " << score << " nodes " << nodes << " nps "
+                 << size_t(ms > 0 ? nodes * 1000 / ms : 0) << " time " << size_t(ms) << " pv " << steps_to_string(pv);
+            print(info.str());
+        };
+
+        vector<move_pos> best;
+        logic.find_turns(color, mtx);
+        if (!logic.turns.empty())
+            best = logic.search(mtx, color, limits);
+
+        // При ponder и infinite bestmove выводится только после stop или ponderhit
+        {
+            unique_lock<mutex> lock(state_mtx);
+            state_cv.wait(lock, [this]() { return stop || (!pondering && !infinite); });
+        }
+        if (best.empty())
+        {
+            print("bestmove (none)");
+            return;
+        }
+        auto pv = split_turns(logic.last_pv);
+        string res = "bestmove " + turn_to_string(best);
+        if (pv.size() > 1)
+            res += " ponder " + turn_to_string(pv[1]);
+        print(res);
+    }
+
+    void ponder_hit()
+    {
+        {
+            lock_guard<mutex> lock(state_mtx);
+            if (!pondering)
+                return;
+            pondering = false;
+        }
+        state_cv.notify_all();
+        if (movetime)
+            start_timer();
+    }
+
+    // Останавливает поиск по истечении movetime
+    void start_timer()
+    {
+        if (timer.joinable())
+            timer.join();
+        timer = thread([this]() {
+            unique_lock<mutex> lock(state_mtx);
+            if (!state_cv.wait_for(lock, chrono::milliseconds(movetime), [this]() { return bool(stop); }))
+                stop = true;
+            state_cv.notify_all();
+        });
+    }
+
+    void stop_search()
+    {
+        {
+            lock_guard<mutex> lock(state_mtx);
+            stop = true;
+        }
+        state_cv.notify_all();
+        if (searcher.joinable())
+            searcher.join();
+        if (timer.joinable())
+            timer.join();
+        movetime = 0;
+    }
+
+  private:
+    Config *config;
+    Logic logic;
+    vector<vector<POS_T>> mtx;
+    bool color = 0;
+
+    thread searcher, timer;
+    atomic<bool> stop{false};
+    bool pondering = false, infinite = false;
+    unsigned movetime = 0;
+    chrono::steady_clock::time_point search_start;
+    mutex state_mtx, out_mtx;
+    condition_variable state_cv;
+};
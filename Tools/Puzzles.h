@@ -0,0 +1,362 @@
+#pragma once
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Notation.h"
+#include "../Engine/Pdn.h"
+#include "../Models/Project_path.h"
+#include "../Models/Puzzle.h"
+#include "../Models/Record.h"
+#include "Batch_runner.h"
+
+// Поиск тактических задач в архивах партий PDN и файлах self-play (Models/Record.h, определяется по заголовку):
+// позиции, где ходящая сторона выигрывает материал единственной форсированной комбинацией со взятиями.
+// Отбор в два этапа. Дешёвый: у ходящего хотя бы два хода, и глубокий поиск (DeepLevel) оценивает позицию
+// хотя бы на SwingMargin выше мелкого (ShallowLevel) - мелкий поиск комбинацию не видит. Проверка: на каждом
+// ходе решения анализ двух лучших ходов (VerifyLevel) - лучший должен быть хотя бы на UniqueMargin сильнее второго,
+// ответ противника - его лучший ход; решение заканчивается, когда после хода решающей стороны и лучшего ответа
+// выигрыш фигур не меньше MinGain (и решающая сторона хоть раз брала), но не дальше MaxTurns ходов.
+// Повторы позиций (дебюты) отбрасываются таблицей ключей размером DedupMB. Позиции проверяются в пуле потоков
+// Tools/Batch_runner.h (у каждого потока свой Logic, в работе не больше BatchPositions позиций), задачи пишутся
+// в порядке входа в бинарную базу Models/Puzzle.h и, если задан TextOutput, текстом "FEN решение".
+class Puzzles
+{
+  public:
+    Puzzles(Config *config) : config(config)
+    {
+        config->set("Bot", "NoRandom", true); // одинаковая база при повторном запуске
+        config->set("Bot", "CacheFile", "");
+        config->set("Bot", "SolverNodes", 0);
+        config->set("Bot", "Engine", "AlphaBeta");
+        config->set("Bot", "TraceFile", "");
+    }
+
+    int run(vector<string> inputs = {})
+    {
+        if (inputs.empty())
+            inputs.push_back(project_path + string((*config)("Puzzles", "Input")));
+        shallow.level = (*config)("Puzzles", "ShallowLevel");
+        deep.level = (*config)("Puzzles", "DeepLevel");
+        verify.level = (*config)("Puzzles", "VerifyLevel");
+        swing_margin = (*config)("Puzzles", "SwingMargin");
+        unique_margin = (*config)("Puzzles", "UniqueMargin");
+        min_gain = (*config)("Puzzles", "MinGain");
+        max_turns = (*config)("Puzzles", "MaxTurns");
+        size_t dedup_size = 1;
+        while (dedup_size * 2 * sizeof(uint64_t) <= size_t((*config)("Puzzles", "DedupMB")) * 1024 * 1024)
+            dedup_size *= 2;
+        dedup.assign(dedup_size, 0);
+
+        const string out_path = project_path + string((*config)("Puzzles", "Output"));
+        const string text_path = (*config)("Puzzles", "TextOutput");
+        ofstream fout(out_path, ios::binary | ios::trunc);
+        if (!fout)
+        {
+            cerr << "Puzzles: can't open " << out_path << endl;
+            return 1;
+        }
+        puzzle_header header;
+        header.record_size = sizeof(puzzle_record);
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ofstream text;
+        if (!text_path.empty())
+            text.open(project_path + text_path, ios::trunc);
+
+        Batch_runner<item, mine_stats> runner(config, "Puzzles");
+        cout << "Puzzles: " << inputs.size() << " inputs -> " << out_path << ", " << runner.threads()
+             << " threads, levels " << shallow.level << "/" << deep.level << "/" << verify.level << endl;
+
+        Logic reader_logic(config); // разбор ходов партий PDN и запись решений текстом
+        size_t read = 0, puzzles = 0;
+        auto start = chrono::steady_clock::now();
+        for (const auto &path : inputs)
+        {
+            if (!open_input(path, reader_logic))
+                continue;
+            runner.run(
+                [this, &read](item &it) {
+                    while (next_position(it.rec))
+                    {
+                        ++read;
+                        if (!seen(it.rec))
+                            return true;
+                    }
+                    return false;
+                },
+                [this](item &it, Logic &logic, mine_stats &st) { it.is_puzzle = mine(logic, st, it.rec, it.found); },
+                [this, &fout, &text, &reader_logic, &puzzles](const item &it) {
+                    if (!it.is_puzzle)
+                        return;
+                    ++puzzles;
+                    fout.write(reinterpret_cast<const char *>(&it.found), sizeof(puzzle_record));
+                    if (text)
+                        text << to_text(reader_logic, it.found) << '\n';
+                },
+                [&read, &puzzles, start](const size_t screened, const mine_stats &total) {
+                    print_progress(read, screened, puzzles, total, start);
+                });
+        }
+        fout.close();
+        cout << endl;
+        return 0;
+    }
+
+  private:
+    // Позиция входа и найденная задача
+    struct item
+    {
+        position_record rec;
+        puzzle_record found;
+        bool is_puzzle = false;
+    };
+
+    struct mine_stats
+    {
+        size_t candidates = 0; // прошли дешёвый отбор
+        size_t nodes = 0;
+
+        mine_stats &operator+=(const mine_stats &other)
+        {
+            candidates += other.candidates;
+            nodes += other.nodes;
+            return *this;
+        }
+    };
+
+    bool open_input(const string &path, Logic &logic)
+    {
+        fin.close();
+        fin.clear();
+        fin.open(path, ios::binary);
+        if (!fin)
+        {
+            cerr << "Puzzles: can't open " << path << endl;
+            return false;
+        }
+        record_header header;
+        fin.read(reinterpret_cast<char *>(&header), sizeof(header));
+        binary = fin.gcount() == sizeof(header) && header.magic == RECORD_MAGIC;
+        if (binary && (header.version != RECORD_VERSION || header.record_size != sizeof(position_record)))
+        {
+            cerr << "Puzzles: " << path << " has incompatible format" << endl;
+            return false;
+        }
+        if (!binary)
+        {
+            fin.clear();
+            fin.seekg(0);
+            reader.reset(new Pdn_reader(fin));
+            reader_logic = &logic;
+        }
+        pending.clear();
+        pending_pos = 0;
+        game_id = 0;
+        return true;
+    }
+
+    // Следующая позиция входа: запись self-play или позиция очередной партии PDN
+    bool next_position(position_record &rec)
+    {
+        if (binary)
+        {
+            fin.read(reinterpret_cast<char *>(&rec), sizeof(rec));
+            return fin.gcount() == sizeof(rec);
+        }
+        while (pending_pos == pending.size())
+        {
+            pdn_game game;
+            if (!reader->next(game))
+                return false;
+            pending.clear();
+            pending_pos = 0;
+            replay_pdn(*reader_logic, game, [this](const vector<vector<POS_T>> &mtx, bool color, const vector<move_pos> &) {
+                position_record r{};
+                pack_board(mtx, r);
+                r.side = color;
+                r.game_id = game_id;
+                r.ply = uint16_t(pending.size());
+                pending.push_back(r);
+            });
+            ++game_id;
+        }
+        rec = pending[pending_pos++];
+        return true;
+    }
+
+    // Позиция уже встречалась (с потерями: ключ вытесняет ключ с тем же номером ячейки)
+    bool seen(const position_record &rec)
+    {
+        uint64_t key = (uint64_t(rec.white) << 32 | rec.black) * 0x9E3779B97F4A7C15ull ^
+                       (uint64_t(rec.kings) << 1 | rec.side) * 0xC2B2AE3D27D4EB4Full;
+        key ^= key >> 29;
+        key |= 1ull << 63; // 0 - пустая ячейка; старший бит не входит в номер ячейки
+        uint64_t &slot = dedup[key & (dedup.size() - 1)];
+        if (slot == key)
+            return true;
+        slot = key;
+        return false;
+    }
+
+    // Отбор и проверка позиции, выполняется в потоке пула
+    bool mine(Logic &logic, mine_stats &st, const position_record &rec, puzzle_record &res)
+    {
+        const vector<vector<POS_T>> mtx = unpack_board(rec);
+        const bool color = rec.side;
+        vector<vector<move_pos>> turns;
+        vector<move_pos> path;
+        logic.find_full_turns(mtx, color, path, turns);
+        if (turns.size() < 2)
+            return false;
+        logic.search(mtx, color, shallow);
+        const SCORE_T shallow_score = logic.last_score;
+        st.nodes += logic.nodes;
+        logic.search(mtx, color, deep);
+        const SCORE_T deep_score = logic.last_score;
+        st.nodes += logic.nodes;
+        if (deep_score < shallow_score + swing_margin || deep_score <= shallow_score)
+            return false;
+        ++st.candidates;
+        return verify_solution(logic, st, rec, mtx, color, res);
+    }
+
+    bool verify_solution(Logic &logic, mine_stats &st, const position_record &rec, vector<vector<POS_T>> mtx,
+                         const bool color, puzzle_record &res)
+    {
+        const int mine_before = pieces(mtx, color), theirs_before = pieces(mtx, !color);
+        vector<move_pos> solution;
+        bool captured = false;
+        for (int t = 0; t < max_turns; ++t)
+        {
+            auto lines = logic.multi_pv(mtx, color, 2, verify);
+            st.nodes += logic.nodes;
+            if (lines.empty() || (lines.size() > 1 && lines[0].score < lines[1].score + unique_margin) ||
+                (lines.size() > 1 && lines[0].score <= lines[1].score))
+                return false;
+            if (t == 0)
+            {
+                res.score = float(lines[0].score);
+                res.second = float(lines.size() > 1 ? lines[1].score : 0);
+            }
+            for (const auto &step : lines[0].turn)
+            {
+                captured |= step.xb != -1;
+                mtx = logic.make_turn(mtx, step);
+            }
+            solution.insert(solution.end(), lines[0].turn.begin(), lines[0].turn.end());
+            // Лучший ответ противника (в решение не входит, если решение на этом заканчивается)
+            vector<vector<move_pos>> replies;
+            vector<move_pos> path;
+            logic.find_full_turns(mtx, !color, path, replies);
+            vector<vector<POS_T>> after = mtx;
+            vector<move_pos> reply;
+            if (!replies.empty())
+            {
+                reply = logic.search(mtx, !color, verify);
+                st.nodes += logic.nodes;
+                for (const auto &step : reply)
+                    after = logic.make_turn(after, step);
+            }
+            const int gain = (theirs_before - pieces(after, !color)) - (mine_before - pieces(after, color));
+            if (captured && (replies.empty() || gain >= min_gain))
+            {
+                if (solution.size() > size_t(PUZZLE_MAX_STEPS))
+                    return false;
+                res.white = rec.white;
+                res.black = rec.black;
+                res.kings = rec.kings;
+                res.side = rec.side;
+                res.game_id = rec.game_id;
+                res.ply = rec.ply;
+                res.gain = uint8_t(replies.empty() ? pieces(after, !color) : gain);
+                res.turns = uint8_t(t + 1);
+                res.steps = uint8_t(solution.size());
+                res.reserved = 0;
+                memset(res.solution, 0, sizeof(res.solution));
+                for (size_t k = 0; k < solution.size(); ++k)
+                {
+                    res.solution[k][0] = cell_index(solution[k].x, solution[k].y);
+                    res.solution[k][1] = cell_index(solution[k].x2, solution[k].y2);
+                }
+                return true;
+            }
+            if (reply.empty())
+                return false;
+            solution.insert(solution.end(), reply.begin(), reply.end());
+            mtx = after;
+        }
+        return false;
+    }
+
+    static int pieces(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        int n = 0;
+        for (const auto &row : mtx)
+        {
+            for (const POS_T cell : row)
+                n += cell && (cell % 2 == 0) == color;
+        }
+        return n;
+    }
+
+    // "FEN решение выигрыш"
+    static string to_text(Logic &logic, const puzzle_record &p)
+    {
+        position_record rec{};
+        rec.white = p.white;
+        rec.black = p.black;
+        rec.kings = p.kings;
+        vector<vector<POS_T>> mtx = unpack_board(rec);
+        const string fen = to_fen(mtx, p.side);
+        vector<move_pos> steps;
+        for (int k = 0; k < p.steps; ++k)
+        {
+            auto [x, y] = cell_coords(p.solution[k][0]);
+            auto [x2, y2] = cell_coords(p.solution[k][1]);
+            move_pos step(x, y, x2, y2);
+            // Взятая фигура - единственная фигура между клетками шага
+            for (POS_T i = x + (x2 > x ? 1 : -1), j = y + (y2 > y ? 1 : -1); i != x2; i += (x2 > x ? 1 : -1), j += (y2 > y ? 1 : -1))
+            {
+                if (mtx[i][j])
+                {
+                    step.xb = i;
+                    step.yb = j;
+                }
+            }
+            mtx = logic.make_turn(mtx, step);
+            steps.push_back(step);
+        }
+        stringstream ss;
+        ss << fen << ' ' << steps_to_string(steps) << " gain " << int(p.gain) << " game " << p.game_id << " ply " << p.ply;
+        return ss.str();
+    }
+
+    static void print_progress(const size_t read, const size_t screened, const size_t puzzles, const mine_stats &total,
+                               const chrono::steady_clock::time_point start)
+    {
+        const size_t candidates = total.candidates, nodes = total.nodes;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "\rpositions " << read << ", screened " << screened << ", candidates " << candidates << ", puzzles "
+             << puzzles << ", " << fixed << setprecision(1) << seconds << " s, " << setprecision(0)
+             << (seconds > 0 ? screened / seconds : 0) << " positions screened/s, " << (seconds > 0 ? nodes / seconds : 0)
+             << " nodes/s" << flush;
+    }
+
+  private:
+    Config *config;
+    search_limits shallow, deep, verify;
+    SCORE_T swing_margin = 268, unique_margin = 219; // в единицах оценки (Engine/Score.h)
+    int min_gain = 1, max_turns = 4;
+    vector<uint64_t> dedup; // ключи просмотренных позиций
+    // Текущий вход
+    ifstream fin;
+    bool binary = false;
+    unique_ptr<Pdn_reader> reader;
+    Logic *reader_logic = nullptr;
+    vector<position_record> pending; // позиции текущей партии PDN
+    size_t pending_pos = 0;
+    uint32_t game_id = 0;
+};
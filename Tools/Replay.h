@@ -0,0 +1,142 @@
+#pragma once
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Pdn.h"
+#include "../Engine/Thread_pool.h"
+#include "../Models/Project_path.h"
+
+// Проверка и разбор архива партий PDN: каждая партия проигрывается через генератор ходов.
+// Файл читается потоково пачками по BatchGames партий, пачка проверяется в пуле потоков,
+// поэтому память не зависит от размера архива. При AnalyseLevel >= 0 каждая позиция ещё и просчитывается
+// ботом этого уровня, считается доля ходов партий, совпавших с ходом бота.
+class Replay
+{
+  public:
+    Replay(Config *config) : config(config)
+    {
+    }
+
+    int run(string path = "")
+    {
+        if (path.empty())
+            path = project_path + string((*config)("Replay", "Input"));
+        const size_t batch_games = max(1, int((*config)("Replay", "BatchGames")));
+        analyse_level = (*config)("Replay", "AnalyseLevel");
+        max_errors = (*config)("Replay", "MaxErrors");
+        ifstream fin(path, ios::binary);
+        if (!fin)
+        {
+            cerr << "Replay: can't open " << path << endl;
+            return 1;
+        }
+
+        Thread_pool pool(unsigned(int((*config)("Replay", "Threads"))));
+        logics.clear();
+        stats.assign(pool.size(), worker_stats());
+        for (unsigned i = 0; i < pool.size(); ++i)
+            logics.emplace_back(new Logic(config));
+        cout << "Replay: " << path << ", " << pool.size() << " threads"
+             << (analyse_level >= 0 ? ", analysis level " + to_string(analyse_level) : "") << endl;
+
+        Pdn_reader reader(fin);
+        vector<pdn_game> batch(batch_games);
+        vector<string> errors(batch_games);
+        size_t games = 0, bad = 0;
+        auto start = chrono::steady_clock::now();
+        while (true)
+        {
+            size_t n = 0;
+            while (n < batch_games && reader.next(batch[n]))
+                ++n;
+            if (n == 0)
+                break;
+            // Пачка делится на части по числу потоков
+            const size_t chunk = (n + pool.size() - 1) / pool.size();
+            for (size_t from = 0; from < n; from += chunk)
+            {
+                pool.submit([this, &batch, &errors, from, to = min(n, from + chunk)]() {
+                    for (size_t k = from; k < to; ++k)
+                        errors[k] = check(batch[k]);
+                });
+            }
+            pool.wait_idle();
+            for (size_t k = 0; k < n; ++k)
+            {
+                if (errors[k].empty())
+                    continue;
+                if (bad++ < max_errors)
+                    cout << (games ? "\r" + string(100, ' ') + "\r" : "") << "game " << games + k + 1 << " (" << batch[k].tag("White")
+                         << " - " << batch[k].tag("Black") << ", " << batch[k].tag("Date") << "): " << errors[k] << endl;
+            }
+            games += n;
+            print_progress(games, bad, reader.bytes_read(), start);
+        }
+        cout << endl;
+        if (analyse_level >= 0)
+        {
+            size_t positions = 0, same = 0;
+            for (auto &st : stats)
+            {
+                positions += st.analysed;
+                same += st.same;
+            }
+            cout << "Analysis: " << positions << " positions, bot agrees with " << fixed << setprecision(1)
+                 << (positions ? 100.0 * same / positions : 0) << "% of moves" << endl;
+        }
+        return bad ? 2 : 0;
+    }
+
+  private:
+    // Выполняется в потоке пула
+    string check(const pdn_game &game)
+    {
+        const size_t id = Thread_pool::worker_id();
+        Logic &logic = *logics[id];
+        worker_stats &st = stats[id];
+        size_t turns = 0;
+        string error = replay_pdn(logic, game, [&](const vector<vector<POS_T>> &mtx, bool color,
+                                                   const vector<move_pos> &turn) {
+            ++turns;
+            if (analyse_level < 0)
+                return;
+            logic.Max_depth = analyse_level;
+            auto best = logic.find_best_turns(mtx, color);
+            ++st.analysed;
+            st.same += best.size() == turn.size() && equal(best.begin(), best.end(), turn.begin());
+        });
+        st.turns += turns;
+        return error;
+    }
+
+    void print_progress(const size_t games, const size_t bad, const size_t bytes,
+                        const chrono::steady_clock::time_point start) const
+    {
+        size_t turns = 0;
+        for (auto &st : stats)
+            turns += st.turns;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "\rgames " << games << ", invalid " << bad << ", moves " << turns << ", " << fixed << setprecision(0)
+             << (seconds > 0 ? games / seconds : 0) << " games/s, " << (seconds > 0 ? turns / seconds : 0)
+             << " moves/s, " << setprecision(1) << (seconds > 0 ? bytes / seconds / 1e6 : 0) << " MB/s" << flush;
+    }
+
+  private:
+    // Счётчики потока пула (без общих атомарных переменных)
+    struct alignas(64) worker_stats
+    {
+        size_t turns = 0;
+        size_t analysed = 0;
+        size_t same = 0;
+    };
+
+    Config *config;
+    int analyse_level = -1;
+    size_t max_errors = 0;
+    vector<unique_ptr<Logic>> logics; // Logic каждого потока пула
+    vector<worker_stats> stats;
+};
@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+
+#include "../Models/Project_path.h"
+#include "../Models/Record.h"
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+
+// Генерация обучающих данных: партии бот против бота без окна в нескольких потоках.
+// Каждая законченная партия целиком дописывается в бинарный файл (Models/Record.h),
+// поэтому после прерывания генерация продолжается с недостающих партий.
+class Selfplay
+{
+  public:
+    Selfplay(Config *config) : config(config)
+    {
+    }
+
+    int run()
+    {
+        const string out_path = project_path + string((*config)("Selfplay", "Output"));
+        games = (*config)("Selfplay", "Games");
+        depth = (*config)("Selfplay", "Depth");
+        opening_turns = (*config)("Selfplay", "RandomOpeningTurns");
+        seed = (*config)("Selfplay", "Seed");
+        max_turns = (*config)("Game", "MaxNumTurns");
+        unsigned workers = (*config)("Selfplay", "Workers");
+        if (workers == 0)
+            workers = max(1u, thread::hardware_concurrency());
+
+        if (!open_output(out_path))
+            return 1;
+        resumed = positions;
+        cout << "Selfplay: " << done.size() << " of " << games << " games already in " << out_path << endl;
+
+        start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (unsigned w = 0; w < workers; ++w)
+            pool.emplace_back(&Selfplay::worker, this);
+        for (auto &th : pool)
+            th.join();
+        fout.close();
+
+        print_progress();
+        cout << endl;
+        return 0;
+    }
+
+  private:
+    // Открывает файл на дозапись: проверяет заголовок, отрезает недописанный хвост
+    // и запоминает номера уже сыгранных партий
+    bool open_output(const string &path)
+    {
+        namespace fs = std::filesystem;
+        record_header header;
+        header.record_size = sizeof(position_record);
+        if (!fs::exists(path) || fs::file_size(path) < sizeof(record_header))
+        {
+            ofstream init(path, ios::binary | ios::trunc);
+            init.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            init.close();
+        }
+        else
+        {
+            ifstream fin(path, ios::binary);
+            record_header old;
+            fin.read(reinterpret_cast<char *>(&old), sizeof(old));
+            if (old.magic != header.magic || old.version != header.version || old.record_size != header.record_size)
+            {
+                cerr << "Selfplay: " << path << " has incompatible format" << endl;
+                return false;
+            }
+            // Партии пишутся непрерывными блоками, целостность блока проверяется по game_len
+            size_t valid = 0, count = (fs::file_size(path) - sizeof(header)) / sizeof(position_record);
+            vector<position_record> block;
+            position_record rec;
+            for (size_t i = 0; i < count && fin.read(reinterpret_cast<char *>(&rec), sizeof(rec)); ++i)
+            {
+                if (!block.empty() && block[0].game_id != rec.game_id)
+                    break;
+                block.push_back(rec);
+                if (block.size() == block[0].game_len)
+                {
+                    done.insert(block[0].game_id);
+                    positions += block.size();
+                    valid += block.size();
+                    block.clear();
+                }
+            }
+            fin.close();
+            fs::resize_file(path, sizeof(header) + valid * sizeof(position_record));
+        }
+        fout.open(path, ios::binary | ios::app);
+        return bool(fout);
+    }
+
+    void worker()
+    {
+        Logic logic(config);
+        logic.Max_depth = depth;
+        vector<position_record> recs;
+        while (true)
+        {
+            uint32_t game_id = next_game++;
+            if (game_id >= games)
+                break;
+            if (done.count(game_id))
+                continue;
+            play_game(logic, game_id, recs);
+
+            lock_guard<mutex> lock(write_mtx);
+            fout.write(reinterpret_cast<const char *>(recs.data()), recs.size() * sizeof(position_record));
+            fout.flush();
+            positions += recs.size();
+            if (++played % 10 == 0)
+                print_progress();
+        }
+    }
+
+    // Играет одну партию и заполняет записи её позиций
+    void play_game(Logic &logic, const uint32_t game_id, vector<position_record> &recs) const
+    {
+        recs.clear();
+        logic.reseed(seed + game_id);
+        default_random_engine opening_eng(seed + game_id);
+        auto mtx = Logic::start_mtx();
+        int turn_num = -1;
+        while (++turn_num < max_turns)
+        {
+            const bool color = turn_num % 2;
+            logic.find_turns(color, mtx);
+            if (logic.turns.empty())
+                break;
+            if (turn_num < opening_turns)
+            {
+                // Случайный дебют для разнообразия партий
+                move_pos turn = logic.turns[opening_eng() % logic.turns.size()];
+                mtx = logic.make_turn(mtx, turn);
+                while (turn.xb != -1)
+                {
+                    logic.find_turns(turn.x2, turn.y2, mtx);
+                    if (!logic.have_beats)
+                        break;
+                    turn = logic.turns[opening_eng() % logic.turns.size()];
+                    mtx = logic.make_turn(mtx, turn);
+                }
+                continue;
+            }
+            auto turns = logic.find_best_turns(mtx, color);
+            position_record rec{};
+            pack_board(mtx, rec);
+            rec.score = float(logic.last_score);
+            rec.game_id = game_id;
+            rec.ply = uint16_t(turn_num);
+            rec.side = color;
+            rec.from = cell_index(turns[0].x, turns[0].y);
+            rec.to = cell_index(turns[0].x2, turns[0].y2);
+            recs.push_back(rec);
+            for (auto turn : turns)
+                mtx = logic.make_turn(mtx, turn);
+        }
+        // Итог определяется так же, как в Game::play
+        int8_t res = 2;
+        if (turn_num == max_turns)
+            res = 0;
+        else if (turn_num % 2)
+            res = 1;
+        for (auto &rec : recs)
+        {
+            rec.result = res;
+            rec.game_len = uint16_t(recs.size());
+        }
+    }
+
+    void print_progress() const
+    {
+        double hours = chrono::duration<double>(chrono::steady_clock::now() - start).count() / 3600;
+        cout << "\rgames " << done.size() + played << "/" << games << ", positions " << positions << ", "
+             << (hours > 0 ? int64_t((positions - resumed) / hours) : 0) << " positions/hour" << flush;
+    }
+
+  private:
+    Config *config;
+    uint32_t games = 0;
+    int depth = 0;
+    int opening_turns = 0;
+    int max_turns = 0;
+    unsigned seed = 0;
+
+    set<uint32_t> done; // партии, уже записанные в файл
+    atomic<uint32_t> next_game{0};
+    size_t positions = 0;
+    size_t resumed = 0; // позиции, записанные до перезапуска
+    uint32_t played = 0;
+    chrono::steady_clock::time_point start;
+    mutex write_mtx;
+    ofstream fout;
+};
@@ -0,0 +1,400 @@
+#pragma once
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Notation.h"
+#include "../Engine/Thread_pool.h"
+#include "../Engine/Transposition.h"
+#include "../Models/Histogram.h"
+#include "Socket.h"
+
+// Сервер партий: много одновременных партий (сессий) по TCP на общем пуле потоков.
+// Каждое соединение - отдельная партия. Команды (по строке, как в Protocol.h):
+//   isready                                   -> readyok
+//   newgame                                   новая партия, начальная позиция, бюджет времени заново
+//   position startpos|fen <FEN> [moves <ход> ...]
+//   go [depth N] [nodes N] [movetime MS]      -> info depth D score S nodes N time MS, затем bestmove <ход>
+//   stop                                      остановить поиск этой партии
+//   budget MS                                 бюджет времени партии на все ходы бота, 0 - без ограничения
+//   stats                                     -> stats ... (метрики сервера)
+//   quit
+// Поиски выполняются в пуле потоков, у каждого потока свой Logic, таблица транспозиций общая.
+// Сокеты партий неблокирующие, все записи в них делает поток соединений: ответы копятся в буфере партии и
+// отправляются, когда сокет готов (POLLOUT). Поток пула только дописывает результат в буфер и будит poll через
+// пару сокетов wake, поэтому клиент, который не читает ответы, не останавливает ни другие партии, ни поиски.
+// Партия, у которой в буфере больше MAX_OUTPUT неотправленных байт, закрывается.
+// У партии может быть только один поиск в очереди или в работе (иначе "error busy"), поэтому
+// партии с частыми запросами не вытесняют остальные. Поиски раскладываются по очередям потоков пула по кругу,
+// и потоки (в том числе при перехвате) берут их из начала очередей, то есть примерно в порядке поступления.
+class Server
+{
+  public:
+    Server(Config *config) : config(config)
+    {
+    }
+
+    int run()
+    {
+        const string host = (*config)("Server", "Host");
+        const int port = (*config)("Server", "Port");
+        const size_t hash_mb = (*config)("Server", "HashMB");
+        max_sessions = (*config)("Server", "MaxSessions");
+        session_budget_ms = (*config)("Server", "SessionBudgetMS");
+        moves_to_go = max(1, int((*config)("Server", "MovesToGo")));
+        const int stats_interval = (*config)("Server", "StatsIntervalS");
+
+        if (!socket_init())
+        {
+            cerr << "Can't initialize sockets" << endl;
+            return 1;
+        }
+        socket_t listener = socket_listen(host, port);
+        if (listener == BAD_SOCKET)
+        {
+            cerr << "Can't listen on " << host << ":" << port << endl;
+            return 1;
+        }
+        if (!socket_pair(wake_in, wake_out))
+        {
+            cerr << "Can't create wake sockets" << endl;
+            return 1;
+        }
+
+        // Потоки пула используют общую таблицу вместо собственных
+        config->set("Bot", "HashMB", 0);
+        if (hash_mb)
+            tt = make_shared<Transposition>(hash_mb);
+        Thread_pool pool(unsigned(int((*config)("Server", "Workers"))));
+        this->pool = &pool;
+        for (unsigned i = 0; i < pool.size(); ++i)
+        {
+            logics.emplace_back(new Logic(config));
+            logics.back()->tt = tt;
+        }
+        parser.reset(new Logic(config));
+        start_time = chrono::steady_clock::now();
+        cout << "Server on " << host << ":" << port << ", " << pool.size() << " workers, hash "
+             << (tt ? tt->size_mb() : 0) << " MB" << endl;
+
+        auto last_stats = chrono::steady_clock::now();
+        vector<poll_fd> fds;
+        vector<shared_ptr<session>> polled;
+        while (true)
+        {
+            // Отправка накопленных ответов; партии с неотправленным остатком ждут POLLOUT
+            fds.assign(2, poll_fd{});
+            fds[0].fd = listener;
+            fds[0].events = POLLIN;
+            fds[1].fd = wake_in;
+            fds[1].events = POLLIN;
+            polled.clear();
+            for (auto it = sessions.begin(); it != sessions.end();)
+            {
+                auto s = (it++)->second;
+                bool pending = false;
+                if (!flush(s, pending))
+                {
+                    close_session(s);
+                    continue;
+                }
+                poll_fd p = {};
+                p.fd = s->fd;
+                p.events = POLLIN | (pending ? POLLOUT : 0);
+                fds.push_back(p);
+                polled.push_back(s);
+            }
+            if (socket_poll(fds, 1000) < 0)
+                continue;
+
+            if (fds[0].revents & POLLIN)
+                accept_session(listener);
+            if (fds[1].revents & POLLIN)
+            {
+                char buf[256];
+                while (recv(wake_in, buf, sizeof(buf), 0) > 0)
+                {
+                }
+                wake_pending = false;
+            }
+            for (size_t k = 2; k < fds.size(); ++k)
+            {
+                if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+                auto &s = polled[k - 2];
+                vector<string> lines;
+                bool alive = s->reader.read(s->fd, lines);
+                for (size_t i = 0; alive && i < lines.size(); ++i)
+                    alive = handle(s, lines[i]);
+                if (!alive)
+                    close_session(s);
+            }
+
+            if (stats_interval > 0 && chrono::steady_clock::now() - last_stats >= chrono::seconds(stats_interval))
+            {
+                last_stats = chrono::steady_clock::now();
+                cout << stats_line() << endl;
+            }
+        }
+        return 0;
+    }
+
+  private:
+    // Партия одного соединения
+    struct session
+    {
+        socket_t fd;
+        line_reader reader;
+        vector<vector<POS_T>> mtx = Logic::start_mtx();
+        bool color = 0;
+        double budget_ms = 0; // оставшийся бюджет времени, меньше 0 - без ограничения
+        atomic<bool> stop{false};
+        atomic<bool> busy{false};  // поиск в очереди или в работе, позицию меняет только он
+        atomic<bool> closed{false};
+        mutex out_mtx;
+        string out;       // ответы, ещё не отправленные клиенту
+        size_t sent = 0;  // отправленная часть out
+
+        ~session()
+        {
+            socket_close(fd);
+        }
+
+        // Ответ в буфер, отправляет его поток соединений
+        void send(const string &line)
+        {
+            lock_guard<mutex> lock(out_mtx);
+            if (!closed)
+                out += line + "\n";
+        }
+
+        // Результат поиска: партия освобождается вместе с записью в буфер, чтобы команда сразу после bestmove
+        // не получила "error busy"
+        void send_result(const string &lines)
+        {
+            lock_guard<mutex> lock(out_mtx);
+            busy = false;
+            if (!closed)
+                out += lines;
+        }
+    };
+
+    // Отправляет буфер партии без ожидания. pending - остался неотправленный остаток, false - соединение
+    // разорвано или клиент не читает ответы (буфер больше MAX_OUTPUT)
+    bool flush(const shared_ptr<session> &s, bool &pending)
+    {
+        lock_guard<mutex> lock(s->out_mtx);
+        if (s->closed)
+            return false;
+        if (!socket_send_some(s->fd, s->out, s->sent))
+            return false;
+        if (s->sent == s->out.size())
+        {
+            s->out.clear();
+            s->sent = 0;
+        }
+        else if (s->sent > s->out.size() / 2)
+        {
+            s->out.erase(0, s->sent);
+            s->sent = 0;
+        }
+        pending = !s->out.empty();
+        return s->out.size() - s->sent <= MAX_OUTPUT;
+    }
+
+    // Будит poll потока соединений (из потока пула): одного байта в сокете достаточно
+    void wake()
+    {
+        if (!wake_pending.exchange(true))
+            send(wake_out, "w", 1, 0);
+    }
+
+    void accept_session(const socket_t listener)
+    {
+        socket_t fd = socket_accept(listener);
+        if (fd == BAD_SOCKET)
+            return;
+        auto s = make_shared<session>();
+        s->fd = fd;
+        socket_set_nonblocking(fd);
+        if (max_sessions && sessions.size() >= max_sessions)
+        {
+            // Одна попытка без ожидания, затем соединение закрывается
+            size_t sent = 0;
+            socket_send_some(fd, "error server full\n", sent);
+            return;
+        }
+        s->budget_ms = session_budget_ms ? session_budget_ms : -1;
+        sessions[fd] = s;
+        ++total_sessions;
+        s->send("ready");
+    }
+
+    void close_session(const shared_ptr<session> &s)
+    {
+        // Сокет закрывается, когда поиск партии (если он есть) завершится. Ответы до "quit" отправляются
+        // одной попыткой без ожидания
+        bool pending = false;
+        flush(s, pending);
+        s->stop = true;
+        s->closed = true;
+        sessions.erase(s->fd);
+    }
+
+    // Обработка одной команды, false - закрыть соединение
+    bool handle(const shared_ptr<session> &s, const string &line)
+    {
+        stringstream ss(line);
+        string cmd;
+        ss >> cmd;
+        if (cmd.empty())
+            return true;
+        if (cmd == "quit")
+            return false;
+        if (cmd == "isready")
+            s->send("readyok");
+        else if (cmd == "stats")
+            s->send(stats_line());
+        else if (cmd == "stop")
+            s->stop = true;
+        else if (s->busy)
+            s->send("error busy");
+        else if (cmd == "newgame")
+        {
+            s->mtx = Logic::start_mtx();
+            s->color = 0;
+            s->budget_ms = session_budget_ms ? session_budget_ms : -1;
+        }
+        else if (cmd == "position")
+        {
+            string error = parse_position(*parser, ss, s->mtx, s->color);
+            if (!error.empty())
+                s->send("error " + error);
+        }
+        else if (cmd == "budget")
+        {
+            double ms = 0;
+            ss >> ms;
+            s->budget_ms = ms > 0 ? ms : -1;
+        }
+        else if (cmd == "go")
+            go(s, ss);
+        else
+            s->send("error unknown command " + cmd);
+        return true;
+    }
+
+    void go(const shared_ptr<session> &s, stringstream &ss)
+    {
+        search_limits limits;
+        limits.level = (*config)("Bot", string(s->color ? "Black" : "White") + "BotLevel");
+        bool has_depth = false, has_limit = false;
+        string word;
+        while (ss >> word)
+        {
+            if (word == "depth" && ss >> limits.level)
+            {
+                limits.level = max(limits.level - 1, 0);
+                has_depth = true;
+            }
+            else if (word == "nodes" && ss >> limits.nodes)
+                has_limit = true;
+            else if (word == "movetime" && ss >> limits.time_ms)
+                has_limit = true;
+        }
+        // Доля оставшегося бюджета партии на этот ход; бюджет исчерпан - ход без просчёта вперёд
+        if (s->budget_ms >= 0)
+        {
+            unsigned share = unsigned(s->budget_ms / moves_to_go);
+            if (share == 0)
+            {
+                limits = search_limits();
+                has_depth = true;
+            }
+            else
+            {
+                limits.time_ms = limits.time_ms ? min(limits.time_ms, share) : share;
+                has_limit = true;
+            }
+        }
+        if (has_limit && !has_depth)
+            limits.level = -1;
+
+        s->stop = false;
+        s->busy = true;
+        auto queued = chrono::steady_clock::now();
+        pool->submit([this, s, limits, queued]() { search(s, limits, queued); });
+    }
+
+    // Выполняется в потоке пула
+    void search(const shared_ptr<session> &s, const search_limits limits, const chrono::steady_clock::time_point queued)
+    {
+        auto start = chrono::steady_clock::now();
+        queue_wait.add(chrono::duration<double, micro>(start - queued).count());
+        Logic &logic = *logics[Thread_pool::worker_id()];
+        logic.stop_signal = &s->stop;
+
+        vector<move_pos> best;
+        logic.find_turns(s->color, s->mtx);
+        if (!logic.turns.empty() && !s->closed)
+            best = logic.search(s->mtx, s->color, limits);
+        logic.stop_signal = nullptr;
+
+        auto end = chrono::steady_clock::now();
+        double ms = chrono::duration<double, milli>(end - start).count();
+        search_time.add(ms * 1000);
+        response_time.add(chrono::duration<double, micro>(end - queued).count());
+        searches.fetch_add(1, memory_order_relaxed);
+        total_nodes.fetch_add(logic.nodes, memory_order_relaxed);
+        if (s->budget_ms >= 0)
+            s->budget_ms = max(0.0, s->budget_ms - ms);
+
+        stringstream res;
+        if (best.empty())
+            res << "bestmove (none)\n";
+        else
+            res << "info depth " << logic.last_level + 1 << " score " << logic.last_score << " nodes " << logic.nodes
+                << " time " << size_t(ms) << "\nbestmove " << turn_to_string(best) << "\n";
+        s->send_result(res.str());
+        wake();
+    }
+
+    // Метрики: задержки в очереди, время поиска и полного ответа (p50/p99, мс), скорость, попадания в таблицу
+    string stats_line() const
+    {
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+        stringstream res;
+        res << fixed << setprecision(2) << "stats sessions " << sessions.size() << " total_sessions "
+            << total_sessions << " searches " << searches.load() << " queue_p50 " << queue_wait.percentile(50) / 1000
+            << " queue_p99 " << queue_wait.percentile(99) / 1000 << " search_p50 " << search_time.percentile(50) / 1000
+            << " search_p99 " << search_time.percentile(99) / 1000 << " response_p99 "
+            << response_time.percentile(99) / 1000 << " nps " << size_t(seconds > 0 ? total_nodes / seconds : 0)
+            << " tt_hits " << (tt ? tt->hit_count() : 0);
+        return res.str();
+    }
+
+  private:
+    Config *config;
+    Thread_pool *pool = nullptr;
+    vector<unique_ptr<Logic>> logics; // Logic каждого потока пула
+    unique_ptr<Logic> parser;         // разбор ходов в потоке соединений
+    shared_ptr<Transposition> tt;
+    map<socket_t, shared_ptr<session>> sessions;
+    static const size_t MAX_OUTPUT = 1 << 20;
+    socket_t wake_in = BAD_SOCKET, wake_out = BAD_SOCKET; // пара сокетов для пробуждения poll из потоков пула
+    atomic<bool> wake_pending{false};
+    size_t max_sessions = 0;
+    double session_budget_ms = 0;
+    int moves_to_go = 1;
+
+    // Метрики
+    chrono::steady_clock::time_point start_time;
+    size_t total_sessions = 0;
+    Histogram queue_wait, search_time, response_time; // мкс
+    atomic<size_t> searches{0}, total_nodes{0};
+};
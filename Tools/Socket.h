@@ -0,0 +1,266 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+typedef WSAPOLLFD poll_fd;
+const socket_t BAD_SOCKET = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+typedef pollfd poll_fd;
+const socket_t BAD_SOCKET = -1;
+#endif
+
+using namespace std;
+
+// Минимальная обёртка над TCP сокетами (POSIX и Winsock) для текстовых протоколов инструментов:
+// сервер партий (Tools/server.cpp) и распределённый self-play. Сокеты блокирующие, чтение строк через line_reader;
+// сервер переводит сокеты партий в неблокирующий режим и отправляет данные частями через socket_send_some.
+
+inline bool socket_init()
+{
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+inline void socket_close(const socket_t s)
+{
+#ifdef _WIN32
+    closesocket(s);
+#else
+    close(s);
+#endif
+}
+
+// Ожидание событий на сокетах, timeout_ms < 0 - без ограничения
+inline int socket_poll(vector<poll_fd> &fds, const int timeout_ms)
+{
+#ifdef _WIN32
+    return WSAPoll(fds.data(), ULONG(fds.size()), timeout_ms);
+#else
+    return poll(fds.data(), nfds_t(fds.size()), timeout_ms);
+#endif
+}
+
+// Открывает сокет, принимающий соединения на host:port. BAD_SOCKET при ошибке
+inline socket_t socket_listen(const string &host, const int port, const int backlog = 128)
+{
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), to_string(port).c_str(), &hints, &res) != 0)
+        return BAD_SOCKET;
+    socket_t s = BAD_SOCKET;
+    for (addrinfo *p = res; p && s == BAD_SOCKET; p = p->ai_next)
+    {
+        s = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (s == BAD_SOCKET)
+            continue;
+        int yes = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&yes, sizeof(yes));
+        if (bind(s, p->ai_addr, int(p->ai_addrlen)) != 0 || listen(s, backlog) != 0)
+        {
+            socket_close(s);
+            s = BAD_SOCKET;
+        }
+    }
+    freeaddrinfo(res);
+    return s;
+}
+
+// Подключение к host:port. BAD_SOCKET при ошибке
+inline socket_t socket_connect(const string &host, const int port)
+{
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &res) != 0)
+        return BAD_SOCKET;
+    socket_t s = BAD_SOCKET;
+    for (addrinfo *p = res; p && s == BAD_SOCKET; p = p->ai_next)
+    {
+        s = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (s == BAD_SOCKET)
+            continue;
+        if (connect(s, p->ai_addr, int(p->ai_addrlen)) != 0)
+        {
+            socket_close(s);
+            s = BAD_SOCKET;
+        }
+    }
+    freeaddrinfo(res);
+    if (s != BAD_SOCKET)
+    {
+        // Короткие строки протокола отправляются сразу
+        int yes = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&yes, sizeof(yes));
+    }
+    return s;
+}
+
+inline socket_t socket_accept(const socket_t listener)
+{
+    socket_t s = accept(listener, nullptr, nullptr);
+    if (s != BAD_SOCKET)
+    {
+        int yes = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&yes, sizeof(yes));
+    }
+    return s;
+}
+
+// Отправляет данные целиком, false при разрыве соединения
+inline bool socket_send(const socket_t s, const string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+#ifdef _WIN32
+        int n = send(s, data.data() + sent, int(data.size() - sent), 0);
+#else
+        ssize_t n = send(s, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#endif
+        if (n <= 0)
+            return false;
+        sent += size_t(n);
+    }
+    return true;
+}
+
+// Переводит сокет в неблокирующий режим
+inline bool socket_set_nonblocking(const socket_t s)
+{
+#ifdef _WIN32
+    u_long yes = 1;
+    return ioctlsocket(s, FIONBIO, &yes) == 0;
+#else
+    const int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// Последняя операция неблокирующего сокета не выполнена, потому что буфер полон (запись) или пуст (чтение)
+inline bool socket_would_block()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+// Отправляет сколько получится без ожидания, начиная с data[sent]; sent увеличивается на отправленное.
+// false при разрыве соединения
+inline bool socket_send_some(const socket_t s, const string &data, size_t &sent)
+{
+    while (sent < data.size())
+    {
+#ifdef _WIN32
+        int n = send(s, data.data() + sent, int(data.size() - sent), 0);
+#else
+        ssize_t n = send(s, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#endif
+        if (n < 0 && socket_would_block())
+            return true;
+        if (n <= 0)
+            return false;
+        sent += size_t(n);
+    }
+    return true;
+}
+
+// Пара соединённых сокетов через loopback (как pipe, но годится для poll и на Windows): запись в out
+// будит poll, ждущий in. false при ошибке
+inline bool socket_pair(socket_t &in, socket_t &out)
+{
+    in = out = BAD_SOCKET;
+    socket_t listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == BAD_SOCKET)
+        return false;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listener, (sockaddr *)&addr, sizeof(addr)) == 0 && listen(listener, 1) == 0 &&
+        getsockname(listener, (sockaddr *)&addr, &len) == 0)
+    {
+        out = socket(AF_INET, SOCK_STREAM, 0);
+        if (out != BAD_SOCKET && connect(out, (sockaddr *)&addr, sizeof(addr)) == 0)
+            in = accept(listener, nullptr, nullptr);
+    }
+    socket_close(listener);
+    if (in == BAD_SOCKET)
+    {
+        if (out != BAD_SOCKET)
+            socket_close(out);
+        out = BAD_SOCKET;
+        return false;
+    }
+    socket_set_nonblocking(in);
+    socket_set_nonblocking(out);
+    return true;
+}
+
+// Накопитель входящих данных, выдаёт полные строки (без '\r' и '\n')
+class line_reader
+{
+  public:
+    // Читает доступные данные (один вызов recv) и добавляет полные строки в lines. false при разрыве соединения
+    bool read(const socket_t s, vector<string> &lines)
+    {
+        char chunk[4096];
+        int n = int(recv(s, chunk, sizeof(chunk), 0));
+        if (n < 0 && socket_would_block()) // неблокирующий сокет: данных пока нет
+            return true;
+        if (n <= 0)
+            return false;
+        buf.append(chunk, size_t(n));
+        size_t start = 0, end;
+        while ((end = buf.find('\n', start)) != string::npos)
+        {
+            string line = buf.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            lines.push_back(line);
+            start = end + 1;
+        }
+        buf.erase(0, start);
+        // Защита от строк без конца
+        return buf.size() <= MAX_LINE;
+    }
+
+    // Блокирующее чтение одной строки. false при разрыве соединения
+    bool read_line(const socket_t s, string &line)
+    {
+        while (pending.empty())
+        {
+            if (!read(s, pending))
+                return false;
+        }
+        line = pending.front();
+        pending.erase(pending.begin());
+        return true;
+    }
+
+  private:
+    static const size_t MAX_LINE = 1 << 20;
+    string buf;
+    vector<string> pending;
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Notation.h"
+#include "../Engine/Solver.h"
+#include "../Engine/Thread_pool.h"
+#include "../Models/Project_path.h"
+
+// Пакетный решатель тактики: для каждой позиции файла (FEN в строке, строки с # и пустые пропускаются)
+// доказывается форсированный выигрыш ходящей стороны решателем Engine/Solver.h. Позиции решаются в пуле потоков,
+// у каждого потока свой генератор ходов и своя таблица решателя, результаты выводятся в порядке файла.
+class Solve
+{
+  public:
+    Solve(Config *config) : config(config)
+    {
+        config->set("Bot", "NoRandom", true);
+        config->set("Bot", "CacheFile", "");
+        config->set("Bot", "SolverNodes", 0); // решатель создаётся здесь, у Logic свой не нужен
+    }
+
+    int run(string path = "")
+    {
+        if (path.empty())
+            path = project_path + string((*config)("Solve", "Input"));
+        max_nodes = (*config)("Solve", "Nodes");
+        max_plies = (*config)("Solve", "Plies");
+        const size_t hash_mb = (*config)("Solve", "HashMB");
+        ifstream fin(path);
+        if (!fin)
+        {
+            cerr << "Solve: can't open " << path << endl;
+            return 1;
+        }
+        vector<string> fens;
+        string line;
+        while (getline(fin, line))
+        {
+            while (!line.empty() && isspace((unsigned char)line.back()))
+                line.pop_back();
+            if (!line.empty() && line[0] != '#')
+                fens.push_back(line);
+        }
+
+        Thread_pool pool(unsigned(int((*config)("Solve", "Threads"))));
+        logics.clear();
+        solvers.clear();
+        for (unsigned i = 0; i < pool.size(); ++i)
+        {
+            logics.emplace_back(new Logic(config));
+            solvers.emplace_back(new Solver<Logic>(hash_mb));
+        }
+        cout << "Solve: " << fens.size() << " positions from " << path << ", " << pool.size() << " threads, "
+             << max_plies << " plies, " << max_nodes << " nodes" << endl;
+
+        results.assign(fens.size(), solve_result());
+        auto start = chrono::steady_clock::now();
+        for (size_t k = 0; k < fens.size(); ++k)
+            pool.submit([this, &fens, k]() { results[k] = solve(fens[k]); });
+        pool.wait_idle();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        size_t counts[4] = {}, nodes = 0;
+        static const char *names[] = {"unknown", "win", "no win", "bad FEN"};
+        for (size_t k = 0; k < fens.size(); ++k)
+        {
+            const solve_result &r = results[k];
+            ++counts[r.result];
+            nodes += r.nodes;
+            cout << fens[k] << "  " << names[r.result];
+            if (r.result == Solver<Logic>::WIN)
+                cout << "  " << r.line;
+            cout << "  nodes " << r.nodes << ", " << fixed << setprecision(1) << r.ms << " ms" << endl;
+        }
+        cout << "Total: win " << counts[Solver<Logic>::WIN] << ", no win " << counts[Solver<Logic>::NO_WIN]
+             << ", unknown " << counts[Solver<Logic>::UNKNOWN] << ", bad " << counts[BAD_FEN] << ", nodes " << nodes
+             << ", " << setprecision(1) << seconds << " s, " << setprecision(0)
+             << (seconds > 0 ? fens.size() / seconds : 0) << " positions/s, " << (seconds > 0 ? nodes / seconds : 0)
+             << " nodes/s" << endl;
+        return 0;
+    }
+
+  private:
+    static const int BAD_FEN = 3;
+
+    struct solve_result
+    {
+        int result = Solver<Logic>::UNKNOWN;
+        string line; // выигрышная линия в нотации
+        size_t nodes = 0;
+        double ms = 0;
+    };
+
+    // Выполняется в потоке пула
+    solve_result solve(const string &fen)
+    {
+        const size_t id = Thread_pool::worker_id();
+        solve_result res;
+        vector<vector<POS_T>> mtx;
+        bool color;
+        if (!from_fen(fen, mtx, color))
+        {
+            res.result = BAD_FEN;
+            return res;
+        }
+        auto start = chrono::steady_clock::now();
+        vector<move_pos> line;
+        res.result = solvers[id]->solve(*logics[id], mtx, color, max_plies, max_nodes, line);
+        res.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        res.nodes = solvers[id]->nodes;
+        res.line = steps_to_string(line);
+        return res;
+    }
+
+  private:
+    Config *config;
+    size_t max_nodes = 0;
+    int max_plies = 0;
+    vector<unique_ptr<Logic>> logics;           // Logic каждого потока пула
+    vector<unique_ptr<Solver<Logic>>> solvers; // решатель каждого потока пула
+    vector<solve_result> results;
+};
@@ -0,0 +1,219 @@
+#pragma once
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include "../Engine/Config.h"
+#include "../Engine/Notation.h"
+#include "../Engine/Search_trace.h"
+#include "../Models/Project_path.h"
+#include "../Models/Record.h"
+
+// Сравнение двух записей дерева поиска (Engine/Search_trace.h). Файлы читаются потоково пачками и сравниваются
+// запись за записью: выводится первое расхождение (номер записи, номер поиска, путь ходов от корня до узла
+// и обе записи), затем по каждой глубине количество узлов, отсечений и попаданий в таблицу транспозиций
+// в обоих файлах и разница. С одним файлом выводится только статистика по глубинам.
+class Trace_diff
+{
+  public:
+    Trace_diff(Config *config) : config(config)
+    {
+    }
+
+    int run(const string &path_a, const string &path_b = "")
+    {
+        path_length = (*config)("TraceDiff", "PathLength");
+        const bool compare = !path_b.empty();
+        if (!open(path_a, traces[0]) || (compare && !open(path_b, traces[1])))
+            return 1;
+        cout << "Trace " << path_a << ": seed " << traces[0].header.seed << endl;
+        if (compare)
+            cout << "Trace " << path_b << ": seed " << traces[1].header.seed << endl;
+
+        bool diverged = false;
+        trace_record a, b;
+        while (true)
+        {
+            const bool has_a = next(traces[0], a), has_b = compare && next(traces[1], b);
+            if (!has_a && !has_b)
+                break;
+            if (compare && !diverged && (has_a != has_b || !same(a, b)))
+            {
+                diverged = true;
+                print_divergence(has_a ? &a : nullptr, has_b ? &b : nullptr);
+            }
+        }
+        if (compare && !diverged)
+            cout << "Traces are identical: " << traces[0].records << " records" << endl;
+        print_depths(compare);
+        return diverged ? 2 : 0;
+    }
+
+  private:
+    // Счётчики глубины
+    struct depth_stats
+    {
+        size_t nodes = 0;
+        size_t cutoffs = 0;
+        size_t tt_hits = 0;
+    };
+
+    struct trace_file
+    {
+        ifstream fin;
+        trace_header header;
+        vector<trace_record> buffer;
+        size_t pos = 0;
+        size_t records = 0;  // прочитано записей
+        size_t searches = 0; // прочитано записей SEARCH
+        bool full = false;
+        vector<trace_record> path; // записи ENTER открытых узлов
+        map<int, depth_stats> depths;
+    };
+
+    static const size_t BUFFER_RECORDS = 65536;
+
+    bool open(const string &path, trace_file &t) const
+    {
+        t.fin.open(path, ios::binary);
+        if (!t.fin)
+        {
+            cerr << "TraceDiff: can't open " << path << endl;
+            return false;
+        }
+        t.fin.read(reinterpret_cast<char *>(&t.header), sizeof(t.header));
+        if (!t.fin || t.header.magic != TRACE_MAGIC || t.header.version != TRACE_VERSION ||
+            t.header.record_size != sizeof(trace_record))
+        {
+            cerr << "TraceDiff: " << path << " is not a search trace of this version" << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Следующая запись файла с учётом статистики и пути
+    bool next(trace_file &t, trace_record &r) const
+    {
+        if (t.pos == t.buffer.size())
+        {
+            t.buffer.resize(BUFFER_RECORDS);
+            t.fin.read(reinterpret_cast<char *>(t.buffer.data()), BUFFER_RECORDS * sizeof(trace_record));
+            t.buffer.resize(size_t(t.fin.gcount()) / sizeof(trace_record));
+            t.pos = 0;
+            if (t.buffer.empty())
+                return false;
+        }
+        r = t.buffer[t.pos++];
+        ++t.records;
+        switch (r.type)
+        {
+        case trace_record::SEARCH:
+            ++t.searches;
+            t.path.clear();
+            break;
+        case trace_record::ENTER:
+            ++t.depths[r.depth].nodes;
+            t.path.push_back(r);
+            break;
+        case trace_record::EXIT:
+            t.depths[r.depth].cutoffs += (r.flags & trace_record::CUTOFF) != 0;
+            t.depths[r.depth].tt_hits += (r.flags & trace_record::TT_HIT) != 0;
+            if (!t.path.empty())
+                t.path.pop_back();
+            break;
+        case trace_record::FULL:
+            t.full = true;
+            break;
+        }
+        return true;
+    }
+
+    static bool same(const trace_record &a, const trace_record &b)
+    {
+        return memcmp(&a, &b, sizeof(a)) == 0;
+    }
+
+    static string move_name(const trace_record &r)
+    {
+        if (r.from == 0xff)
+            return "root";
+        auto [x, y] = cell_coords(r.from);
+        auto [x2, y2] = cell_coords(r.to);
+        return cell_name(x, y) + "-" + cell_name(x2, y2);
+    }
+
+    static string describe(const trace_record *r)
+    {
+        if (!r)
+            return "end of file";
+        static const char *types[] = {"SEARCH", "ENTER", "EXIT", "FULL"};
+        stringstream ss;
+        ss << (r->type <= trace_record::FULL ? types[r->type] : "?") << " depth " << int(r->depth);
+        if (r->type == trace_record::SEARCH)
+            ss << " key " << hex << r->key << dec;
+        if (r->type == trace_record::ENTER)
+            ss << " ply " << int(r->ply) << " move " << move_name(*r) << " window [" << r->alpha << ", " << r->beta
+               << "]";
+        if (r->type == trace_record::EXIT)
+            ss << " ply " << int(r->ply) << " score " << r->score << ((r->flags & trace_record::CUTOFF) ? " cutoff" : "")
+               << ((r->flags & trace_record::TT_HIT) ? " tt" : "") << ((r->flags & trace_record::LEAF) ? " leaf" : "")
+               << ((r->flags & trace_record::ABORTED) ? " aborted" : "");
+        return ss.str();
+    }
+
+    void print_divergence(const trace_record *a, const trace_record *b) const
+    {
+        const trace_file &t = traces[0];
+        cout << "First divergence at record " << t.records << " (search " << t.searches << ")" << endl;
+        // Путь до узла (без последней записи, она выводится отдельно)
+        size_t end = t.path.size() - (a && a->type == trace_record::ENTER ? 1 : 0);
+        size_t begin = end > path_length ? end - path_length : 0;
+        cout << "  path:" << (begin ? " ..." : "");
+        for (size_t k = begin; k < end; ++k)
+            cout << ' ' << move_name(t.path[k]);
+        cout << endl;
+        cout << "  A: " << describe(a) << endl;
+        cout << "  B: " << describe(b) << endl;
+    }
+
+    void print_depths(const bool compare) const
+    {
+        map<int, bool> depths;
+        for (const auto &t : traces)
+        {
+            for (const auto &[d, st] : t.depths)
+                depths[d] = true;
+        }
+        cout << "depth" << setw(14) << "nodes A" << setw(12) << "cutoffs A" << setw(10) << "tt A";
+        if (compare)
+            cout << setw(14) << "nodes B" << setw(12) << "cutoffs B" << setw(10) << "tt B" << setw(12) << "diff";
+        cout << endl;
+        for (const auto &[d, unused] : depths)
+        {
+            const depth_stats a = stats(traces[0], d), b = stats(traces[1], d);
+            cout << setw(5) << d << setw(14) << a.nodes << setw(12) << a.cutoffs << setw(10) << a.tt_hits;
+            if (compare)
+                cout << setw(14) << b.nodes << setw(12) << b.cutoffs << setw(10) << b.tt_hits << setw(12)
+                     << showpos << (long long)(b.nodes) - (long long)(a.nodes) << noshowpos;
+            cout << endl;
+        }
+        for (const auto &t : traces)
+        {
+            if (t.full)
+                cout << "Warning: a trace was truncated by Bot.TraceMB" << endl;
+        }
+    }
+
+    static depth_stats stats(const trace_file &t, const int depth)
+    {
+        auto it = t.depths.find(depth);
+        return it == t.depths.end() ? depth_stats() : it->second;
+    }
+
+  private:
+    Config *config;
+    size_t path_length = 16;
+    trace_file traces[2];
+};
@@ -0,0 +1,311 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define TUNER_SSE2
+#endif
+
+#include "../Models/Project_path.h"
+#include "../Models/Record.h"
+#include "../Engine/Config.h"
+
+// Подбор коэффициентов Logic::calc_score ("NumberAndPotential") методом Texel:
+// логистическая регрессия оценки позиции на результаты партий из файла self-play (Models/Record.h).
+// Оценка e = ln((шашки + p * потенциал + q * дамки) / (то же для соперника)) со стороны ходящего,
+// прогноз результата sigmoid(K * e), минимизируется среднеквадратичная ошибка по p и q.
+class Tuner
+{
+  public:
+    Tuner(Config *config) : config(config)
+    {
+    }
+
+    int run()
+    {
+        const string in_path = project_path + string((*config)("Tuner", "Input"));
+        const string out_path = project_path + string((*config)("Bot", "WeightsFile"));
+        const int iterations = (*config)("Tuner", "Iterations");
+        const double lr = (*config)("Tuner", "LearningRate");
+        threads = (*config)("Tuner", "Threads");
+        if (threads == 0)
+            threads = max(1u, thread::hardware_concurrency());
+
+        auto start = chrono::steady_clock::now();
+        if (!load(in_path))
+            return 1;
+        cout << "Tuner: " << size() << " positions loaded in "
+             << (int)chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " millisec"
+             << endl;
+        if (size() == 0)
+            return 1;
+
+        // Начальные значения - текущие коэффициенты бота
+        double p = 0.05, q = 5;
+        ifstream win(out_path);
+        if (win)
+        {
+            json weights;
+            win >> weights;
+            p = weights["PotentialCoef"];
+            q = weights["QueenCoef"];
+        }
+        fit_k(p, q);
+        cout << "K = " << k << ", loss = " << evaluate(p, q).loss << endl;
+
+        // Градиентный спуск Adam по p и q
+        double m[2] = {0, 0}, v[2] = {0, 0};
+        const double b1 = 0.9, b2 = 0.999;
+        for (int it = 1; it <= iterations; ++it)
+        {
+            auto st = evaluate(p, q);
+            double g[2] = {st.grad_p, st.grad_q};
+            double *w[2] = {&p, &q};
+            for (int t = 0; t < 2; ++t)
+            {
+                m[t] = b1 * m[t] + (1 - b1) * g[t];
+                v[t] = b2 * v[t] + (1 - b2) * g[t] * g[t];
+                double mh = m[t] / (1 - pow(b1, it)), vh = v[t] / (1 - pow(b2, it));
+                *w[t] -= lr * mh / (sqrt(vh) + 1e-12);
+            }
+            p = max(p, 0.0);
+            q = max(q, 1.0);
+            if (it % 50 == 0 || it == iterations)
+                cout << "iteration " << it << ": loss " << st.loss << ", PotentialCoef " << p << ", QueenCoef " << q
+                     << endl;
+        }
+
+        json weights;
+        weights["PotentialCoef"] = p;
+        weights["QueenCoef"] = q;
+        weights["K"] = k;
+        weights["Loss"] = evaluate(p, q).loss;
+        weights["Positions"] = size();
+        ofstream fout(out_path);
+        fout << weights.dump(2) << endl;
+        fout.close();
+        cout << "Weights saved to " << out_path << endl;
+        return 0;
+    }
+
+  private:
+    // Признаки позиций хранятся по столбцам (structure of arrays) для пакетной обработки
+    struct features
+    {
+        vector<float> own_men, own_kings, own_pot;
+        vector<float> opp_men, opp_kings, opp_pot;
+        vector<float> target; // 1 - победа ходящего, 0.5 - ничья, 0 - поражение
+    };
+
+    struct stats
+    {
+        double loss = 0, grad_p = 0, grad_q = 0;
+    };
+
+    size_t size() const
+    {
+        return f.target.size();
+    }
+
+    // Потоковое чтение файла пакетами и извлечение признаков
+    bool load(const string &path)
+    {
+        ifstream fin(path, ios::binary);
+        record_header header;
+        if (!fin.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != RECORD_MAGIC ||
+            header.version != RECORD_VERSION || header.record_size != sizeof(position_record))
+        {
+            cerr << "Tuner: can't read dataset " << path << endl;
+            return false;
+        }
+        vector<position_record> batch(1 << 16);
+        while (fin)
+        {
+            fin.read(reinterpret_cast<char *>(batch.data()), batch.size() * sizeof(position_record));
+            size_t n = fin.gcount() / sizeof(position_record);
+            if (n == 0)
+                break;
+            extract(batch.data(), n);
+        }
+        return true;
+    }
+
+    // Маски клеток, у которых номер ряда (idx / 4) содержит бит 0, 1 и 2
+    static constexpr uint32_t ROW_BIT0 = 0xf0f0f0f0, ROW_BIT1 = 0xff00ff00, ROW_BIT2 = 0xffff0000;
+
+    static uint32_t popcount32(uint32_t x)
+    {
+        x = x - ((x >> 1) & 0x55555555);
+        x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+        x = (x + (x >> 4)) & 0x0f0f0f0f;
+        return (x * 0x01010101) >> 24;
+    }
+
+    // Сумма номеров рядов по маске
+    static uint32_t row_sum(uint32_t x)
+    {
+        return popcount32(x & ROW_BIT0) + 2 * popcount32(x & ROW_BIT1) + 4 * popcount32(x & ROW_BIT2);
+    }
+
+#ifdef TUNER_SSE2
+    static __m128i popcount4(__m128i x)
+    {
+        const __m128i m1 = _mm_set1_epi32(0x55555555), m2 = _mm_set1_epi32(0x33333333),
+                      m4 = _mm_set1_epi32(0x0f0f0f0f);
+        x = _mm_sub_epi32(x, _mm_and_si128(_mm_srli_epi32(x, 1), m1));
+        x = _mm_add_epi32(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi32(x, 2), m2));
+        x = _mm_and_si128(_mm_add_epi32(x, _mm_srli_epi32(x, 4)), m4);
+        x = _mm_add_epi32(x, _mm_srli_epi32(x, 8));
+        x = _mm_add_epi32(x, _mm_srli_epi32(x, 16));
+        return _mm_and_si128(x, _mm_set1_epi32(0x3f));
+    }
+
+    static __m128i row_sum4(__m128i x)
+    {
+        __m128i r0 = popcount4(_mm_and_si128(x, _mm_set1_epi32(int(ROW_BIT0))));
+        __m128i r1 = popcount4(_mm_and_si128(x, _mm_set1_epi32(int(ROW_BIT1))));
+        __m128i r2 = popcount4(_mm_and_si128(x, _mm_set1_epi32(int(ROW_BIT2))));
+        return _mm_add_epi32(r0, _mm_add_epi32(_mm_slli_epi32(r1, 1), _mm_slli_epi32(r2, 2)));
+    }
+
+    static __m128i select4(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+#endif
+
+    // Признаки пакета записей: по 4 позиции за раз на SSE2, остаток - скалярно
+    void extract(const position_record *recs, const size_t n)
+    {
+        size_t base = size();
+        for (auto *col : {&f.own_men, &f.own_kings, &f.own_pot, &f.opp_men, &f.opp_kings, &f.opp_pot, &f.target})
+            col->resize(base + n);
+        size_t i = 0;
+#ifdef TUNER_SSE2
+        for (; i + 4 <= n; i += 4)
+        {
+            const position_record *r = recs + i;
+            __m128i white = _mm_setr_epi32(r[0].white, r[1].white, r[2].white, r[3].white);
+            __m128i black = _mm_setr_epi32(r[0].black, r[1].black, r[2].black, r[3].black);
+            __m128i kings = _mm_setr_epi32(r[0].kings, r[1].kings, r[2].kings, r[3].kings);
+            __m128i black_side = _mm_setr_epi32(-int(r[0].side), -int(r[1].side), -int(r[2].side), -int(r[3].side));
+
+            __m128i wm = _mm_andnot_si128(kings, white), bm = _mm_andnot_si128(kings, black);
+            __m128i w_men = popcount4(wm), b_men = popcount4(bm);
+            __m128i w_kings = popcount4(_mm_and_si128(kings, white)), b_kings = popcount4(_mm_and_si128(kings, black));
+            // Потенциал белых - 7 - ряд, черных - ряд
+            __m128i w_pot = _mm_sub_epi32(_mm_sub_epi32(_mm_slli_epi32(w_men, 3), w_men), row_sum4(wm));
+            __m128i b_pot = row_sum4(bm);
+
+            _mm_storeu_ps(&f.own_men[base + i], _mm_cvtepi32_ps(select4(black_side, b_men, w_men)));
+            _mm_storeu_ps(&f.own_kings[base + i], _mm_cvtepi32_ps(select4(black_side, b_kings, w_kings)));
+            _mm_storeu_ps(&f.own_pot[base + i], _mm_cvtepi32_ps(select4(black_side, b_pot, w_pot)));
+            _mm_storeu_ps(&f.opp_men[base + i], _mm_cvtepi32_ps(select4(black_side, w_men, b_men)));
+            _mm_storeu_ps(&f.opp_kings[base + i], _mm_cvtepi32_ps(select4(black_side, w_kings, b_kings)));
+            _mm_storeu_ps(&f.opp_pot[base + i], _mm_cvtepi32_ps(select4(black_side, w_pot, b_pot)));
+            for (int t = 0; t < 4; ++t)
+                f.target[base + i + t] = target(r[t]);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            const position_record &r = recs[i];
+            uint32_t wm = r.white & ~r.kings, bm = r.black & ~r.kings;
+            float w_men = popcount32(wm), b_men = popcount32(bm);
+            float w_kings = popcount32(r.white & r.kings), b_kings = popcount32(r.black & r.kings);
+            float w_pot = 7 * w_men - row_sum(wm), b_pot = row_sum(bm);
+            if (r.side)
+            {
+                swap(w_men, b_men);
+                swap(w_kings, b_kings);
+                swap(w_pot, b_pot);
+            }
+            f.own_men[base + i] = w_men;
+            f.own_kings[base + i] = w_kings;
+            f.own_pot[base + i] = w_pot;
+            f.opp_men[base + i] = b_men;
+            f.opp_kings[base + i] = b_kings;
+            f.opp_pot[base + i] = b_pot;
+            f.target[base + i] = target(r);
+        }
+    }
+
+    static float target(const position_record &r)
+    {
+        if (r.result == 0)
+            return 0.5f;
+        return (r.result == 1) == (r.side == 0) ? 1.f : 0.f;
+    }
+
+    // Ошибка и градиент на отрезке [from, to)
+    stats evaluate_range(const double p, const double q, const size_t from, const size_t to) const
+    {
+        stats st;
+        for (size_t i = from; i < to; ++i)
+        {
+            double own = f.own_men[i] + p * f.own_pot[i] + q * f.own_kings[i];
+            double opp = f.opp_men[i] + p * f.opp_pot[i] + q * f.opp_kings[i];
+            double e = log(own / opp);
+            double s = 1 / (1 + exp(-k * e));
+            double d = s - f.target[i];
+            st.loss += d * d;
+            double common = 2 * d * s * (1 - s) * k;
+            st.grad_p += common * (f.own_pot[i] / own - f.opp_pot[i] / opp);
+            st.grad_q += common * (f.own_kings[i] / own - f.opp_kings[i] / opp);
+        }
+        return st;
+    }
+
+    // Средние ошибка и градиент по всему набору, посчитанные в нескольких потоках
+    stats evaluate(const double p, const double q) const
+    {
+        vector<stats> part(threads);
+        vector<thread> pool;
+        size_t chunk = (size() + threads - 1) / threads;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            size_t from = min(size(), t * chunk), to = min(size(), from + chunk);
+            pool.emplace_back([this, &part, t, p, q, from, to]() { part[t] = evaluate_range(p, q, from, to); });
+        }
+        stats total;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            pool[t].join();
+            total.loss += part[t].loss / size();
+            total.grad_p += part[t].grad_p / size();
+            total.grad_q += part[t].grad_q / size();
+        }
+        return total;
+    }
+
+    // Подбор масштаба K при фиксированных коэффициентах (поиск по сетке с уточнением)
+    void fit_k(const double p, const double q)
+    {
+        double best = k, step = 1;
+        for (int round = 0; round < 4; ++round, step /= 10)
+        {
+            double center = best, best_loss = 1e18;
+            for (int t = -9; t <= 9; ++t)
+            {
+                k = max(center + t * step, step / 10);
+                double loss = evaluate(p, q).loss;
+                if (loss < best_loss)
+                {
+                    best_loss = loss;
+                    best = k;
+                }
+            }
+        }
+        k = best;
+    }
+
+  private:
+    Config *config;
+    unsigned threads = 1;
+    double k = 1;
+    features f;
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include "../Engine/Config.h"
+#include "../Engine/Logic.h"
+#include "Socket.h"
+
+// Исполнитель распределённого турнира (Tools/cluster.cpp worker). Каждый поток подключается к координатору
+// (Tools/Coordinator.h) и по очереди просит партии:
+//   -> ready
+//   <- game <JSON задания> | wait | done
+//   -> result <JSON результата>
+// Задание содержит всё для партии: номер, начальное значение случайного дебюта, число дебютных ходов,
+// предел ходов и для каждого цвета имя движка, его настройки раздела Bot и ограничения поиска:
+//   {"game":7,"seed":4,"opening_turns":4,"max_turns":120,
+//    "white":{"name":"A","options":{...},"level":3,"nodes":0,"time_ms":0},"black":{...}}
+// Результат: {"game":7,"result":1,"plies":63,"white_nodes":...,"black_nodes":...,"ms":...}, result как в Game::play
+// (0 - ничья, 1 - победа белых, 2 - победа черных). Остальные настройки берутся из settings.json исполнителя.
+class Worker
+{
+  public:
+    Worker(Config *config) : config(config)
+    {
+    }
+
+    int run(string host = "")
+    {
+        if (host.empty())
+            host = string((*config)("Cluster", "Host"));
+        const int port = (*config)("Cluster", "Port");
+        unsigned threads = (*config)("Cluster", "WorkerThreads");
+        if (threads == 0)
+            threads = max(1u, thread::hardware_concurrency());
+        if (!socket_init())
+        {
+            cerr << "Can't initialize sockets" << endl;
+            return 1;
+        }
+        cout << "Worker: " << threads << " threads, coordinator " << host << ":" << port << endl;
+        vector<thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(&Worker::connection, this, host, port);
+        for (auto &th : pool)
+            th.join();
+        cout << "Worker: " << played << " games played" << endl;
+        return 0;
+    }
+
+  private:
+    void connection(const string host, const int port)
+    {
+        // Координатор может ещё не запуститься
+        socket_t s = BAD_SOCKET;
+        for (int attempt = 0; attempt < 30 && s == BAD_SOCKET; ++attempt)
+        {
+            s = socket_connect(host, port);
+            if (s == BAD_SOCKET)
+                this_thread::sleep_for(chrono::seconds(1));
+        }
+        if (s == BAD_SOCKET)
+        {
+            cerr << "Worker: can't connect to " << host << ":" << port << endl;
+            return;
+        }
+        line_reader reader;
+        string line;
+        while (socket_send(s, "ready\n") && reader.read_line(s, line))
+        {
+            if (line == "done")
+                break;
+            if (line == "wait")
+            {
+                this_thread::sleep_for(chrono::seconds(1));
+                continue;
+            }
+            if (line.rfind("game ", 0) != 0)
+            {
+                cerr << "Worker: unexpected line " << line << endl;
+                break;
+            }
+            json result;
+            try
+            {
+                result = play(json::parse(line.substr(5)));
+            }
+            catch (const exception &e)
+            {
+                cerr << "Worker: bad assignment: " << e.what() << endl;
+                break;
+            }
+            if (!socket_send(s, "result " + result.dump() + "\n"))
+                break;
+            ++played;
+        }
+        socket_close(s);
+    }
+
+    // Движок одной стороны: настройки бота из задания поверх своих
+    struct side
+    {
+        Config config;
+        Logic logic;
+        search_limits limits;
+
+        side(const Config &base, const json &task) : config(with_options(base, task["options"])), logic(&config)
+        {
+            limits.level = task["level"];
+            limits.nodes = task["nodes"];
+            limits.time_ms = task["time_ms"];
+            if (!limits.bounded())
+                throw runtime_error("level < 0 without nodes or time_ms");
+        }
+
+        static Config with_options(Config config, const json &options)
+        {
+            for (auto &[name, value] : options.items())
+                config.set("Bot", name, value);
+            return config;
+        }
+    };
+
+    json play(const json &task) const
+    {
+        auto start = chrono::steady_clock::now();
+        const int max_turns = task["max_turns"];
+        const int opening_turns = task["opening_turns"];
+        const unsigned seed = task["seed"];
+        side white(*config, task["white"]), black(*config, task["black"]);
+        white.logic.reseed(seed);
+        black.logic.reseed(seed);
+        default_random_engine opening_eng(seed);
+        size_t nodes[2] = {0, 0};
+
+        auto mtx = Logic::start_mtx();
+        int turn_num = -1;
+        while (++turn_num < max_turns)
+        {
+            const bool color = turn_num % 2;
+            Logic &logic = color ? black.logic : white.logic;
+            logic.find_turns(color, mtx);
+            if (logic.turns.empty())
+                break;
+            if (turn_num < opening_turns)
+            {
+                // Случайный дебют, одинаковый для партий с одним seed
+                move_pos turn = logic.turns[opening_eng() % logic.turns.size()];
+                mtx = logic.make_turn(mtx, turn);
+                while (turn.xb != -1)
+                {
+                    logic.find_turns(turn.x2, turn.y2, mtx);
+                    if (!logic.have_beats)
+                        break;
+                    turn = logic.turns[opening_eng() % logic.turns.size()];
+                    mtx = logic.make_turn(mtx, turn);
+                }
+                continue;
+            }
+            auto turns = logic.search(mtx, color, color ? black.limits : white.limits);
+            nodes[color] += logic.nodes;
+            for (auto turn : turns)
+                mtx = logic.make_turn(mtx, turn);
+        }
+        // Итог определяется так же, как в Game::play
+        int res = 2;
+        if (turn_num == max_turns)
+            res = 0;
+        else if (turn_num % 2)
+            res = 1;
+
+        json result;
+        result["game"] = task["game"];
+        result["result"] = res;
+        result["plies"] = turn_num;
+        result["white_nodes"] = nodes[0];
+        result["black_nodes"] = nodes[1];
+        result["ms"] = size_t(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        return result;
+    }
+
+  private:
+    Config *config;
+    atomic<size_t> played{0};
+};
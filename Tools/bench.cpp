@@ -0,0 +1,9 @@
+#include "Bench.h"
+
+// Бенчмарк бота. Настройки берутся из раздела "Bench" и раздела "Bot" файла settings.json
+int main(int argc, char* argv[])
+{
+    Config config;
+    Bench bench(&config);
+    return bench.run();
+}
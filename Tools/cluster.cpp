@@ -0,0 +1,23 @@
+#include "Coordinator.h"
+#include "Worker.h"
+
+// Распределённый турнир движков. Настройки берутся из раздела "Cluster" файла settings.json
+//   cluster coordinator         раздаёт партии и собирает результаты
+//   cluster worker [host]       играет партии, host - адрес координатора (по умолчанию Cluster.Host)
+int main(int argc, char* argv[])
+{
+    Config config;
+    const string role = argc > 1 ? argv[1] : "";
+    if (role == "coordinator")
+    {
+        Coordinator coordinator(&config);
+        return coordinator.run();
+    }
+    if (role == "worker")
+    {
+        Worker worker(&config);
+        return worker.run(argc > 2 ? argv[2] : "");
+    }
+    cerr << "Usage: cluster coordinator | cluster worker [host]" << endl;
+    return 1;
+}
@@ -0,0 +1,9 @@
+#include "Protocol.h"
+
+// Движок с текстовым протоколом через stdin/stdout (описание команд в Protocol.h)
+int main(int argc, char* argv[])
+{
+    Config config;
+    Protocol protocol(&config);
+    return protocol.run();
+}
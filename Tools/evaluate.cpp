@@ -0,0 +1,10 @@
+#include "Evaluate.h"
+
+// Пакетная оценка позиций. Настройки берутся из раздела "Evaluate" файла settings.json
+//   evaluate [вход [выход]]       по умолчанию Evaluate.Input и Evaluate.Output
+int main(int argc, char* argv[])
+{
+    Config config;
+    Evaluate evaluate(&config);
+    return evaluate.run(argc > 1 ? argv[1] : "", argc > 2 ? argv[2] : "");
+}
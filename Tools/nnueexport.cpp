@@ -0,0 +1,9 @@
+#include "Nnue_export.h"
+
+// Запись файла весов нейросети Bot.NnueFile. Настройки берутся из раздела "NnueExport" файла settings.json
+int main(int argc, char* argv[])
+{
+    Config config;
+    Nnue_export exporter(&config);
+    return exporter.run();
+}
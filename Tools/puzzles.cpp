@@ -0,0 +1,10 @@
+#include "Puzzles.h"
+
+// Поиск тактических задач. Настройки берутся из раздела "Puzzles" файла settings.json
+//   puzzles [файл ...]       архивы PDN и файлы self-play, по умолчанию Puzzles.Input
+int main(int argc, char* argv[])
+{
+    Config config;
+    Puzzles puzzles(&config);
+    return puzzles.run(vector<string>(argv + 1, argv + argc));
+}
@@ -0,0 +1,10 @@
+#include "Replay.h"
+
+// Проверка архива партий PDN. Настройки берутся из раздела "Replay" файла settings.json
+//   replay [файл.pdn]       по умолчанию Replay.Input
+int main(int argc, char* argv[])
+{
+    Config config;
+    Replay replay(&config);
+    return replay.run(argc > 1 ? argv[1] : "");
+}
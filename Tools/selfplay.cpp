@@ -0,0 +1,9 @@
+#include "Selfplay.h"
+
+// Генератор обучающих данных. Настройки берутся из раздела "Selfplay" файла settings.json
+int main(int argc, char* argv[])
+{
+    Config config;
+    Selfplay selfplay(&config);
+    return selfplay.run();
+}
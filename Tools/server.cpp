@@ -0,0 +1,9 @@
+#include "Server.h"
+
+// Сервер партий по TCP (описание команд в Server.h). Настройки берутся из раздела "Server" файла settings.json
+int main(int argc, char* argv[])
+{
+    Config config;
+    Server server(&config);
+    return server.run();
+}
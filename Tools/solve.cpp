@@ -0,0 +1,10 @@
+#include "Solve.h"
+
+// Пакетный решатель тактики. Настройки берутся из раздела "Solve" файла settings.json
+//   solve [файл]       позиции FEN по одной в строке, по умолчанию Solve.Input
+int main(int argc, char* argv[])
+{
+    Config config;
+    Solve solve(&config);
+    return solve.run(argc > 1 ? argv[1] : "");
+}
@@ -0,0 +1,15 @@
+#include "Trace_diff.h"
+
+// Сравнение записей дерева поиска (Bot.TraceFile). Настройки берутся из раздела "TraceDiff" файла settings.json
+//   tracediff A [B]       первое расхождение A и B и узлы по глубинам; с одним файлом - только узлы по глубинам
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: tracediff trace_a.bin [trace_b.bin]" << endl;
+        return 1;
+    }
+    Config config;
+    Trace_diff diff(&config);
+    return diff.run(argv[1], argc > 2 ? argv[2] : "");
+}
@@ -0,0 +1,9 @@
+#include "Tuner.h"
+
+// Подбор коэффициентов оценки. Настройки берутся из раздела "Tuner" файла settings.json
+int main(int argc, char* argv[])
+{
+    Config config;
+    Tuner tuner(&config);
+    return tuner.run();
+}
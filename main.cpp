@@ -1,7 +1,18 @@
 #include "Game/Game.h"
+#include "Game/Spectator.h"
 
 int main(int argc, char* argv[])
 {
+    // Spectator.Games > 0 - окно наблюдения за партиями ботов вместо обычной игры
+    {
+        Config config;
+        if (int(config("Spectator", "Games")) > 0)
+        {
+            Spectator spectator(&config);
+            return spectator.run();
+        }
+    }
+
     Game g;
     g.play();
 